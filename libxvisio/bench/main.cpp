@@ -0,0 +1,282 @@
+/**
+ * XVisio microbenchmarks
+ *
+ * Times the per-packet work against the ~1 ms frame budget: packet decode, the
+ * full publish path, pose conversions, batch conversion kernels, callback fan-out
+ * (std::function and typed subscribers) and the example's JSON line. Reports
+ * ns/op and heap allocations per op.
+ *
+ * Usage: ./xvisio_bench [recording.xvr] [--min-time MS]
+ *        Without a recording, a synthetic corpus of moving poses is used.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "packet_recording.h"
+#include "pose_batch.h"
+#include "pose_filter.h"
+#include "pose_hub.h"
+#include "pose_json.h"
+#include "pose_log.h"
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+    int minTimeMs = 200;
+
+    using Packet = std::array<uint8_t, 64>;
+
+    /// Keep a value alive without letting the compiler drop the work producing it
+    template<typename T>
+    void keep(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// Poses on a slow circle with a steady yaw, encoded like EP 0x83 packets
+    std::vector<Packet> syntheticCorpus(size_t count) {
+        std::vector<Packet> corpus(count);
+        for (size_t i = 0; i < count; ++i) {
+            Packet& p = corpus[i];
+            p.fill(0);
+            p[0] = 0x01; p[1] = 0xa2; p[2] = 0x33;
+            const double t = i * 1e-3;
+            const uint32_t timestamp = static_cast<uint32_t>(i * 1000);
+            const int32_t translation[3] = {int32_t(std::cos(t) * 16384), int32_t(std::sin(t) * 16384), 8192};
+            const int16_t quaternion[4] = {int16_t(-std::cos(t / 4) * 16383), 0, int16_t(std::sin(t / 4) * 16383), 0};
+            std::memcpy(p.data() + 3, &timestamp, sizeof(timestamp));
+            std::memcpy(p.data() + 7, translation, sizeof(translation));
+            std::memcpy(p.data() + 19, quaternion, sizeof(quaternion));
+        }
+        return corpus;
+    }
+
+    std::vector<Packet> loadCorpus(const std::string& path) {
+        xv::PacketRecording recording(path);
+        std::vector<Packet> corpus(recording.size());
+        for (size_t i = 0; i < recording.size(); ++i) {
+            std::memcpy(corpus[i].data(), recording[i].data, corpus[i].size());
+        }
+        return corpus;
+    }
+
+    /// Run op(i) for i = 0, 1, ... until minTimeMs has passed, then print ns/op and allocations/op
+    template<typename Op>
+    void bench(const std::string& name, Op&& op) {
+        using Clock = std::chrono::steady_clock;
+        for (size_t i = 0; i < 1000; ++i) op(i);  // warm caches and branch predictors
+
+        size_t ops = 0;
+        size_t batch = 1000;
+        const uint64_t allocsBefore = allocations.load();
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(minTimeMs)) {
+            for (size_t i = 0; i < batch; ++i) op(ops + i);
+            ops += batch;
+            batch *= 2;
+            elapsed = Clock::now() - start;
+        }
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+        const double allocs = double(allocations.load() - allocsBefore) / ops;
+        std::printf("%-36s %10.1f ns/op %8.2f allocs/op\n", name.c_str(), ns, allocs);
+    }
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    std::string corpusPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTimeMs = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            corpusPath = argv[i];
+        } else {
+            std::fprintf(stderr, "Usage: %s [recording.xvr] [--min-time MS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const auto corpus = corpusPath.empty() ? syntheticCorpus(4096) : loadCorpus(corpusPath);
+    if (corpus.empty()) {
+        std::fprintf(stderr, "Empty corpus\n");
+        return 1;
+    }
+    std::printf("corpus: %zu packets (%s)\n\n", corpus.size(), corpusPath.empty() ? "synthetic" : corpusPath.c_str());
+    const size_t n = corpus.size();
+
+    std::vector<xv::RawPose> raws(n);
+    std::vector<xv::Pose> poses(n);
+    for (size_t i = 0; i < n; ++i) {
+        raws[i] = xv::RawPose::decode(corpus[i].data());
+        poses[i] = raws[i].toPose();
+    }
+
+    bench("RawPose::decode", [&](size_t i) { keep(xv::RawPose::decode(corpus[i % n].data())); });
+    {
+        std::array<int16_t, 4> reference{};
+        bench("RawPose::conditionQuaternion", [&](size_t i) {
+            xv::RawPose raw = raws[i % n];
+            reference = raw.conditionQuaternion(reference);
+            keep(raw);
+        });
+    }
+    bench("RawPose::toPose", [&](size_t i) { keep(raws[i % n].toPose()); });
+    bench("Pose::quaternionToMatrix", [&](size_t i) { keep(xv::Pose::quaternionToMatrix(poses[i % n].quaternion)); });
+    bench("Pose::matrixToQuaternion", [&](size_t i) { keep(xv::Pose::matrixToQuaternion(poses[i % n].matrix)); });
+
+    {
+        // One op converts a chunk of CHUNK poses into SoA floats, matrices included
+        constexpr size_t CHUNK = 256;
+        std::vector<float> soa(16 * CHUNK);
+        std::vector<uint32_t> timestamps(CHUNK);
+        xv::batch::PoseArrays arrays;
+        arrays.timestamp = timestamps.data();
+        for (int k = 0; k < 3; ++k) arrays.position[k] = soa.data() + k * CHUNK;
+        for (int k = 0; k < 4; ++k) arrays.quaternion[k] = soa.data() + (3 + k) * CHUNK;
+        for (int k = 0; k < 9; ++k) arrays.matrix[k] = soa.data() + (7 + k) * CHUNK;
+        const size_t chunks = n / CHUNK ? n / CHUNK : 1;
+        const size_t chunk = std::min(CHUNK, n);
+        const auto packetsAt = [&](size_t i) {
+            return xv::batch::packets(corpus[(i % chunks) * chunk].data(), sizeof(Packet), chunk);
+        };
+        const std::string suffix = " x" + std::to_string(chunk);
+
+        bench("batch::convertScalar packets" + suffix, [&](size_t i) {
+            xv::batch::convertScalar(packetsAt(i), arrays);
+            keep(soa[0]);
+        });
+        bench(std::string("batch::convert packets [") + xv::batch::kernel() + "]" + suffix, [&](size_t i) {
+            xv::batch::convert(packetsAt(i), arrays);
+            keep(soa[0]);
+        });
+        bench(std::string("batch::convert RawPoses [") + xv::batch::kernel() + "]" + suffix, [&](size_t i) {
+            xv::batch::convert(xv::batch::rawPoses(&raws[(i % chunks) * chunk], chunk), arrays);
+            keep(soa[0]);
+        });
+    }
+
+    {
+        // Everything the USB thread does per packet: decode, unwrap, clock fit, ring push
+        xv::PoseHub hub;
+        auto ring = hub.openPoseRing();
+        xv::RawPose drained;
+        int64_t hostNs = 0;
+        bench("PoseHub::publish (1 ring)", [&](size_t i) {
+            hub.publish(corpus[i % n].data(), 63, hostNs += 1000000);
+            ring->tryPop(drained);
+        });
+    }
+
+    {
+        // What a render thread pays per frame: clock mapping, bracketing search, lerp/slerp
+        xv::PoseHub hub;
+        int64_t hostNs = 0;
+        for (size_t i = 0; i < 256; ++i) hub.publish(corpus[i % n].data(), 63, hostNs += 1000000);
+        for (const int64_t backNs : {int64_t(300000), int64_t(20000000)}) {
+            bench("PoseHub::sampleAt (" + std::to_string(backNs / 1000) + " us back)",
+                  [&](size_t i) { keep(hub.sampleAt(hostNs - backNs - int64_t(i % 1000))); });
+        }
+    }
+
+    {
+        // Smoothing adds this per packet on the USB thread when enabled
+        xv::PoseFilter filter({true});
+        bench("PoseFilter::apply", [&](size_t i) {
+            xv::RawPose raw = raws[i % n];
+            raw.timeUs = int64_t(i) * 1053;
+            filter.apply(raw);
+            keep(raw);
+        });
+    }
+
+    for (size_t subscribers : {1, 2, 4, 8, 16}) {
+        std::vector<xv::slamCallback> callbacks;
+        double sum = 0.0;
+        for (size_t s = 0; s < subscribers; ++s) {
+            callbacks.emplace_back([&sum](xv::Pose pose) { sum += pose.position[0]; });
+        }
+        bench("slamCallback fan-out x" + std::to_string(subscribers), [&](size_t i) {
+            for (const auto& callback : callbacks) callback(poses[i % n]);
+        });
+        keep(sum);
+    }
+
+    {
+        // What the dispatch thread calls for subscribe<&C::m>(): function pointer plus object, by reference
+        struct Accumulator {
+            double sum = 0.0;
+            void onPose(const xv::Pose& pose) { sum += pose.position[0]; }
+        };
+        for (size_t subscribers : {1, 16}) {
+            std::vector<Accumulator> targets(subscribers);
+            std::vector<xv::Subscriber<xv::Pose>> list;
+            for (auto& target : targets) {
+                list.push_back(xv::Subscriber<xv::Pose>::member<&Accumulator::onPose>(target));
+            }
+            bench("Subscriber<Pose> fan-out x" + std::to_string(subscribers), [&](size_t i) {
+                for (const auto& subscriber : list) subscriber(poses[i % n]);
+            });
+            keep(targets[0].sum);
+        }
+    }
+
+    for (size_t subscribers : {1, 16}) {
+        std::vector<xv::rawSlamCallback> callbacks;
+        int64_t sum = 0;
+        for (size_t s = 0; s < subscribers; ++s) {
+            callbacks.emplace_back([&sum](const xv::RawPose& pose) { sum += pose.translation[0]; });
+        }
+        bench("rawSlamCallback fan-out x" + std::to_string(subscribers), [&](size_t i) {
+            for (const auto& callback : callbacks) callback(raws[i % n]);
+        });
+        keep(sum);
+    }
+
+    {
+        std::ostringstream out;
+        bench("writePoseJson", [&](size_t i) {
+            out.str({});
+            writePoseJson(out, raws[i % n]);
+        });
+    }
+
+    {
+        // Per-pose cost of long captures; host time carries receive jitter as in a live stream
+        const std::string path = "/tmp/xvisio_bench_" + std::to_string(getpid()) + ".xvpl";
+        uint64_t samples = 0;
+        {
+            xv::PoseLogWriter writer(path);
+            bench("PoseLogWriter::append", [&](size_t i) {
+                xv::RawPose raw = raws[i % n];
+                raw.timeUs = int64_t(i) * 1000;
+                raw.hostTimeNs = (raw.timeUs + 4000 + int64_t(i * 7919 % 300)) * 1000;
+                writer.append(raw);
+            });
+            samples = writer.samples();
+        }
+        struct stat file{};
+        stat(path.c_str(), &file);
+        std::printf("%-36s %10.2f bytes/pose\n", "  pose log size", double(file.st_size) / double(samples));
+        unlink(path.c_str());
+    }
+
+    return 0;
+}
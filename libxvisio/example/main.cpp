@@ -1,76 +1,202 @@
 /**
  * XVisio XR50 JSON Stream (with auto-reconnect)
  *
- * Outputs pose data as JSON lines to stdout for WebSocket bridging.
+ * Outputs pose data as JSON lines to stdout for WebSocket bridging, or as
+ * full-rate binary records (see pose_record.h) with --binary.
  * Automatically reconnects when the XR50 resets/disconnects.
  *
+ * --shm NAME additionally publishes every pose to a shared-memory ring (shm_pose.h).
+ * --record PATH appends the raw packets to a recording for ReplaySlam.
+ * --pose-log PATH writes every pose to a compact columnar log (pose_log.h).
+ * --metrics prints a stream health line (rate, jitter, latency, errors) every second.
+ * --realtime PRIO [--cpus LIST] [--mlock] runs the USB event thread under SCHED_FIFO
+ * (MMCSS/time-constraint elsewhere), pinned to LIST (e.g. 2,3), with memory locked.
+ *
  * Usage: sudo ./xvisio_test | node server.js
+ *        sudo ./xvisio_test --binary [--decimate N] [--socket PATH]
+ *        sudo ./xvisio_test --shm /xvisio_pose
  */
 
 #include <iostream>
-#include <iomanip>
 #include <csignal>
 #include <cstdio>
-#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <string>
 #include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include "xvisio.h"
+#include "pose_json.h"
+#include "pose_record.h"
+#include "packet_recording.h"
+#include "pose_log.h"
+#include "shm_publisher.h"
 
 namespace {
     std::atomic<bool> running{true};
     constexpr int MAX_SESSION_RETRIES = 100;
     constexpr int EDGE_CRASH_THRESHOLD = 3;
+    constexpr uint8_t SLAM_TRANSFERS = 4;  // queued EP 0x83 transfers, absorbs host scheduling hiccups
+    // Slam::start() itself waits for the device to come back, so only a short pause between sessions
+    constexpr int RECONNECT_DELAY_MS = 200;
+    constexpr int CRASH_RECONNECT_DELAY_MS = 1000;
+    constexpr int DEVICE_POLL_MS = 500;
 
     // Output throttle: one JSON line per interval
     constexpr int OUTPUT_INTERVAL_MS = 100;
     auto lastOutputTime = std::chrono::steady_clock::now();
 
-    // Change detection for debugging
-    double prevX = 0, prevY = 0, prevZ = 0;
-    double prevW = 0, prevQx = 0, prevQy = 0, prevQz = 0;
+    // Change detection for debugging (raw fixed-point fields compare exactly)
+    xv::RawPose prev;
     int changeCount = 0;
+
+    // Binary mode: every Nth pose to stdout, or to every client of a Unix socket
+    bool binaryOutput = false;
+    int decimation = 1;
+    uint64_t binaryCounter = 0;
+    int listenFd = -1;
+    std::string socketPath;
+    std::vector<int> socketClients;
+    auto lastAcceptTime = std::chrono::steady_clock::time_point{};
+    constexpr int ACCEPT_INTERVAL_MS = 100;
+
+    std::string shmName;
+    std::unique_ptr<xv::PacketRecorder> recorder;  // one recording across reconnects
+    std::unique_ptr<xv::PoseLogWriter> poseLog;    // likewise, fed from each session's pose ring
+    bool showMetrics = false;
+    xv::ThreadPolicy usbThreadPolicy;
+}
+
+/** One stderr line of stream health */
+void printMetrics(const xv::SlamMetrics& m) {
+    uint64_t errors = 0;
+    for (uint64_t count : m.transferErrors) errors += count;
+    uint64_t rejected = 0;
+    for (uint64_t count : m.rejectedPackets) rejected += count;
+    uint64_t slowestNs = 0;
+    for (const auto& subscriber : m.subscribers) slowestNs = std::max(slowestNs, subscriber.maxNs);
+    std::cerr << "[XR50] " << m.packetRateHz << " Hz | jitter " << m.jitterUs << " us | latency "
+              << m.latencyMeanNs / 1000 << " us (max " << m.latencyMaxNs / 1000 << ") | errors " << errors
+              << ", recoveries " << m.recoveries << "/" << m.recoveryAttempts << " | dropped "
+              << m.droppedCallbackPoses << ", rejected " << rejected << " | slowest callback " << slowestNs / 1000 << " us" << std::endl;
+}
+
+/** Blocking write of the whole buffer. Returns false once the reader is gone. */
+bool writeAll(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        const ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+bool openSocket(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[XR50] Socket path too long: " << path << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, 4) < 0) {
+        std::cerr << "[XR50] Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+    socketPath = path;
+    std::cerr << "[XR50] Streaming binary poses on " << path << std::endl;
+    return true;
+}
+
+void closeSocket() {
+    for (int fd : socketClients) close(fd);
+    socketClients.clear();
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+void acceptClients() {
+    const auto preamble = xv::record::preamble();
+    for (int fd; (fd = accept(listenFd, nullptr, nullptr)) >= 0;) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        if (send(fd, preamble.data(), preamble.size(), 0) == static_cast<ssize_t>(preamble.size())) {
+            socketClients.push_back(fd);
+        } else {
+            close(fd);
+        }
+    }
+}
+
+void onBinaryPose(const xv::RawPose& pose) {
+    if (binaryCounter++ % decimation != 0) return;
+    const auto record = xv::record::encode(pose);
+
+    if (listenFd < 0) {
+        if (!writeAll(STDOUT_FILENO, record.data(), record.size())) running = false;
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastAcceptTime >= std::chrono::milliseconds(ACCEPT_INTERVAL_MS)) {
+        lastAcceptTime = now;
+        acceptClients();
+    }
+    // A record goes out whole or not at all (full buffer: skipped); a partial write desyncs the client
+    std::erase_if(socketClients, [&record](int fd) {
+        const ssize_t n = send(fd, record.data(), record.size(), 0);
+        if (n == static_cast<ssize_t>(record.size()) || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+            return false;
+        }
+        close(fd);
+        return true;
+    });
 }
 
-void onPose(const xv::Pose& pose) {
+void onPose(const xv::RawPose& pose) {
+    if (binaryOutput) return onBinaryPose(pose);
+
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastOutputTime).count();
 
-    double w = pose.quaternion[0], x = pose.quaternion[1];
-    double y = pose.quaternion[2], z = pose.quaternion[3];
-    double px = pose.position[0], py = pose.position[1], pz = pose.position[2];
-
     // Detect changes in pose data
-    bool posChanged = (px != prevX || py != prevY || pz != prevZ);
-    bool rotChanged = (w != prevW || x != prevQx || y != prevQy || z != prevQz);
+    bool posChanged = pose.translation != prev.translation;
+    bool rotChanged = pose.quaternion != prev.quaternion;
 
     if (posChanged || rotChanged) {
         changeCount++;
+        const auto [px, py, pz] = pose.position();
+        const auto [w, x, y, z] = pose.orientation();
         std::cerr << "[XR50] POSE CHANGED (#" << changeCount << ")"
                   << " pos=" << posChanged << " rot=" << rotChanged
                   << " | pos(" << px << ", " << py << ", " << pz << ")"
                   << " | quat(" << w << ", " << x << ", " << y << ", " << z << ")"
-                  << " t=" << pose.timestamp << std::endl;
-        prevX = px; prevY = py; prevZ = pz;
-        prevW = w; prevQx = x; prevQy = y; prevQz = z;
+                  << " t=" << pose.timeUs << std::endl;
+        prev = pose;
     }
 
     // Throttle JSON output to stdout
     if (elapsed < OUTPUT_INTERVAL_MS) return;
     lastOutputTime = now;
 
-    double roll  = std::atan2(2.0 * (w * x + y * z), 1.0 - 2.0 * (x * x + y * y)) * 180.0 / M_PI;
-    double pitch = std::asin(std::clamp(2.0 * (w * y - z * x), -1.0, 1.0)) * 180.0 / M_PI;
-    double yaw   = std::atan2(2.0 * (w * z + x * y), 1.0 - 2.0 * (y * y + z * z)) * 180.0 / M_PI;
-
-    std::cout << std::fixed << std::setprecision(4)
-              << "{\"x\":" << px
-              << ",\"y\":" << py
-              << ",\"z\":" << pz
-              << ",\"roll\":" << roll
-              << ",\"pitch\":" << pitch
-              << ",\"yaw\":" << yaw
-              << ",\"t\":" << pose.timestamp << "}\n" << std::flush;
+    writePoseJson(std::cout, pose);
+    std::cout << std::flush;
 }
 
 void printDeviceInfo(const std::shared_ptr<xv::Device>& dev) {
@@ -92,10 +218,10 @@ void printDeviceInfo(const std::shared_ptr<xv::Device>& dev) {
 int runSession(bool verbose, xv::Slam::mode slamMode) {
     xv::XVisio* xvisio = nullptr;
     std::shared_ptr<xv::Slam> slam;
+    std::unique_ptr<xv::ShmPosePublisher> shm;  // unsubscribes from the Slam when destroyed
 
     // Reset change detection per session
-    prevX = prevY = prevZ = 0;
-    prevW = prevQx = prevQy = prevQz = 0;
+    prev = {};
     changeCount = 0;
 
     try {
@@ -107,17 +233,47 @@ int runSession(bool verbose, xv::Slam::mode slamMode) {
         }
 
         auto& dev = devices[0];
-        if (verbose) printDeviceInfo(dev);
+        if (verbose) {
+            const auto& timing = xvisio->getEnumerationTiming();
+            std::cerr << "[XR50] Enumerated " << devices.size() << " device(s) in "
+                      << timing.total.count() / 1000.0 << " ms" << std::endl;
+            printDeviceInfo(dev);
+        }
 
         const char* modeName = (slamMode == xv::Slam::mode::Edge) ? "Edge" : "Mixed";
         std::cerr << "[XR50] Starting " << modeName << " SLAM..." << std::endl;
 
         slam = dev->getSlam();
-        slam->registerSlamCallback(&onPose);
-        slam->start(slamMode);
+        const auto subscription = slam->subscribe<&onPose>();
+        // An unplugged device is picked up again in-process; the session only ends on other failures
+        slam->setAutoReconnect(true);
+        if (!shmName.empty()) shm = std::make_unique<xv::ShmPosePublisher>(*slam, shmName);
+        if (recorder) {
+            slam->registerPacketTap([](const uint8_t* packet, int length, int64_t hostTimeNs) {
+                recorder->append(packet, length, hostTimeNs);
+            });
+        }
+        if (poseLog) poseLog->follow(slam->openPoseRing());
+        if (usbThreadPolicy.realtimePriority > 0 || !usbThreadPolicy.cpus.empty() || usbThreadPolicy.lockMemory) {
+            // Streaming still works without it, just without the latency guarantees
+            try {
+                slam->setThreadPolicy(usbThreadPolicy);
+            } catch (const std::exception& e) {
+                std::cerr << "[XR50] " << e.what() << std::endl;
+            }
+        }
+        slam->start(slamMode, SLAM_TRANSFERS);
+        if (const auto firstPose = slam->getStartupTiming().firstPose; firstPose.count() > 0) {
+            std::cerr << "[XR50] First pose after " << firstPose.count() / 1000.0 << " ms" << std::endl;
+        }
 
-        while (running && slam->running()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Wakes as soon as streaming ends; the timeout only bounds Ctrl+C latency
+        auto nextMetrics = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (running && !slam->waitUntilStopped(std::chrono::milliseconds(250))) {
+            if (showMetrics && std::chrono::steady_clock::now() >= nextMetrics) {
+                printMetrics(slam->getMetrics());
+                nextMetrics += std::chrono::seconds(1);
+            }
         }
 
         int frames = slam->getFrameCount();
@@ -151,7 +307,50 @@ void sleepMs(int ms) {
     }
 }
 
-int main() {
+int usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--binary [--decimate N] [--socket PATH]] [--shm NAME] [--record PATH] [--pose-log PATH]"
+              << " [--metrics] [--realtime PRIO] [--cpus LIST] [--mlock]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    std::string socketArg;
+    std::string recordPath;
+    std::string poseLogPath;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--binary") {
+            binaryOutput = true;
+        } else if (arg == "--decimate" && i + 1 < argc) {
+            decimation = std::atoi(argv[++i]);
+            if (decimation < 1) return usage(argv[0]);
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socketArg = argv[++i];
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shmName = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--pose-log" && i + 1 < argc) {
+            poseLogPath = argv[++i];
+        } else if (arg == "--metrics") {
+            showMetrics = true;
+        } else if (arg == "--realtime" && i + 1 < argc) {
+            usbThreadPolicy.realtimePriority = std::atoi(argv[++i]);
+        } else if (arg == "--cpus" && i + 1 < argc) {
+            for (const char* cpu = argv[++i]; *cpu;) {
+                char* end;
+                usbThreadPolicy.cpus.push_back(int(std::strtol(cpu, &end, 10)));
+                if (end == cpu) return usage(argv[0]);
+                cpu = *end == ',' ? end + 1 : end;
+            }
+        } else if (arg == "--mlock") {
+            usbThreadPolicy.lockMemory = true;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (!binaryOutput && (decimation != 1 || !socketArg.empty())) return usage(argv[0]);
+
     std::ios::sync_with_stdio(false);
     std::cout << std::unitbuf;
     std::setvbuf(stdout, nullptr, _IONBF, 0);
@@ -159,6 +358,25 @@ int main() {
     std::signal(SIGINT, [](int) { running = false; });
     std::signal(SIGPIPE, SIG_IGN);
 
+    if (!recordPath.empty() || !poseLogPath.empty()) {
+        try {
+            if (!recordPath.empty()) recorder = std::make_unique<xv::PacketRecorder>(recordPath);
+            if (!poseLogPath.empty()) poseLog = std::make_unique<xv::PoseLogWriter>(poseLogPath);
+        } catch (const std::exception& e) {
+            std::cerr << "[XR50] " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (binaryOutput) {
+        if (!socketArg.empty()) {
+            if (!openSocket(socketArg)) return 1;
+        } else {
+            const auto preamble = xv::record::preamble();
+            if (!writeAll(STDOUT_FILENO, preamble.data(), preamble.size())) return 1;
+        }
+    }
+
     int session = 0;
     int edgeCrashCount = 0;
     auto slamMode = xv::Slam::mode::Edge;
@@ -169,7 +387,7 @@ int main() {
 
         if (frames == -1) {
             if (session == 0) std::cerr << "[XR50] No device found, waiting..." << std::endl;
-            sleepMs(2000);
+            sleepMs(DEVICE_POLL_MS);
             continue;
         }
 
@@ -187,7 +405,7 @@ int main() {
             edgeCrashCount = 0;
         }
 
-        int delayMs = (frames < 100) ? 6000 : 2000;
+        int delayMs = (frames < 100) ? CRASH_RECONNECT_DELAY_MS : RECONNECT_DELAY_MS;
         std::cerr << "[XR50] Reconnecting in " << delayMs << "ms (session "
                   << session << "/" << MAX_SESSION_RETRIES << ")" << std::endl;
         sleepMs(delayMs);
@@ -197,5 +415,15 @@ int main() {
         std::cerr << "[XR50] Max retries reached (" << MAX_SESSION_RETRIES << ")" << std::endl;
     }
 
+    closeSocket();
+    if (recorder) {
+        std::cerr << "[XR50] Recorded " << recorder->packets() << " packets to " << recordPath << std::endl;
+        recorder.reset();
+    }
+    if (poseLog) {
+        poseLog.reset();  // flushes the last chunk and writes the index
+        const xv::PoseLog log(poseLogPath);
+        std::cerr << "[XR50] Logged " << log.size() << " poses to " << poseLogPath << std::endl;
+    }
     return 0;
 }
@@ -0,0 +1,28 @@
+/**
+ * @file pose_json.h
+ * @brief JSON line written by xvisio_test for each throttled pose
+ */
+
+#ifndef XVISIO_POSE_JSON_H
+#define XVISIO_POSE_JSON_H
+
+#include <iomanip>
+#include <ostream>
+#include "raw_pose.h"
+
+/** {"x":..,"y":..,"z":..,"roll":..,"pitch":..,"yaw":..,"t":..} plus newline; meters, degrees, device µs */
+inline void writePoseJson(std::ostream& out, const xv::RawPose& pose) {
+    const auto [px, py, pz] = pose.position();
+    const auto [roll, pitch, yaw] = pose.eulerDegrees();
+
+    out << std::fixed << std::setprecision(4)
+        << "{\"x\":" << px
+        << ",\"y\":" << py
+        << ",\"z\":" << pz
+        << ",\"roll\":" << roll
+        << ",\"pitch\":" << pitch
+        << ",\"yaw\":" << yaw
+        << ",\"t\":" << pose.timeUs << "}\n";
+}
+
+#endif // XVISIO_POSE_JSON_H
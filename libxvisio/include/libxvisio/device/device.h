@@ -6,26 +6,45 @@
 #ifndef LIBXVISIO_DEVICE_H
 #define LIBXVISIO_DEVICE_H
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <array>
 #include <libusb.h>
 #include "hid.h"
+#include "imu_sample.h"
 
 namespace xv {
 
 class Slam;
+class EventLoop;
 
 class Device {
 public:
-    explicit Device(libusb_device* libusbDevice, libusb_context* context);
+    /// Where opening the device went
+    struct OpenTiming {
+        std::chrono::microseconds open{0};      ///< libusb_open and interface claim
+        std::chrono::microseconds identify{0};  ///< UUID, version and features round trips
+    };
+
+    /// @param timeoutMs HID timeout of each identification command
+    Device(libusb_device* libusbDevice, EventLoop* eventLoop, uint32_t timeoutMs = 1000);
     ~Device();
     
     // Device info
     std::string& getUUID();
     std::string& getVersion();
     
+    [[nodiscard]] const OpenTiming& getOpenTiming() const { return openTiming; }
+
+    /// USB location as "bus-port.port..." (as in sysfs), and the current device address
+    [[nodiscard]] std::string getBusId() const;
+    [[nodiscard]] uint8_t getAddress() const;
+
     // Feature support
+    [[nodiscard]] uint32_t getFeatures() const { return featuresBitmap; }  ///< the bits behind the get*Support()
     [[nodiscard]] bool getEdgeModeSupport() const;
     [[nodiscard]] bool get_mixed_mode_support() const;
     [[nodiscard]] bool getStereoSupport() const;
@@ -38,21 +57,49 @@ public:
     
     // SLAM
     [[nodiscard]] std::shared_ptr<Slam> getSlam() const;
+
+    // Hot reconnect (see Slam::setAutoReconnect)
+    /// False between a disconnect its Slam survived and the device's return
+    [[nodiscard]] bool isConnected() const { return connected; }
+    /// Close the handle of a device that is gone; the Device and its Slam stay.
+    /// Any thread: a command still running elsewhere keeps the handle open until it returns.
+    void detach();
+    /// Take over candidate if it is this device (same UUID) and resume the Slam on it.
+    /// Does synchronous USB I/O: never call on the event loop thread.
+    bool reattach(libusb_device* candidate);
     
     // Configuration
     void configureDevice(bool edge6dof, uint8_t uvcMode, bool embeddedAlgo) const;
     void startEdgeStream(uint8_t edgeMode, bool rotationEnabled, bool flipped) const;
 
+    /// Queue a raw HID command without blocking; completes on the event loop thread.
+    /// Safe while SLAM streams and from callbacks (which must not wait on the future).
+    [[nodiscard]] std::future<HidResult> sendCommand(std::span<const uint8_t> command, uint32_t timeoutMs = 1000) const;
+
+    /// True when the firmware answers a HID query within timeoutMs (never throws)
+    [[nodiscard]] bool probe(uint32_t timeoutMs) const;
+
+    // IMU scale and bias applied to Slam's IMU stream, taking effect at the next Slam::start()
+    [[nodiscard]] const ImuCalibration& getImuCalibration() const;
+    void setImuCalibration(const ImuCalibration& calibration);
+
 private:
-    libusb_device* const libusbDevice;
+    /// The HID channel, held open for the caller; throws while the device is detached
+    std::shared_ptr<HID> channel() const;
+
+    libusb_device* libusbDevice;      // referenced by us, swapped by reattach()
     libusb_context* libusbContext;
+    EventLoop* eventLoop;
+    mutable std::mutex channelMutex;  // guards libusbDevice, handle and hid: detach() runs on the event loop thread
     libusb_device_handle* handle;
-    std::unique_ptr<HID> hid;
+    std::shared_ptr<HID> hid;         // closes the interface once the last holder lets go
     std::string uuid;
     std::string version;
     uint32_t featuresBitmap;
-    std::array<float, 14> imuBias;
+    ImuCalibration imuCalibration;
+    OpenTiming openTiming;
     std::shared_ptr<Slam> slam;
+    std::atomic_bool connected{true};
 };
 
 } // namespace xv
@@ -0,0 +1,89 @@
+/**
+ * @file event_loop.h
+ * @brief The one thread that handles libusb events for an XVisio context
+ */
+
+#ifndef XVISIO_EVENT_LOOP_H
+#define XVISIO_EVENT_LOOP_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <libusb.h>
+#include "thread_policy.h"
+
+namespace xv {
+
+/**
+ * Runs libusb_handle_events for every device on a context, so transfers of all
+ * Slam instances complete on this thread and nobody else contends for the event lock.
+ *
+ * Work that must not run inside a transfer callback (recovery, teardown) is posted
+ * as a task, optionally delayed; the loop sleeps until an event, the next task
+ * deadline or a wake-up, instead of polling.
+ *
+ * On Linux (epoll + eventfd) and macOS (kqueue + pipe) the loop blocks on libusb's
+ * own pollfds and only enters libusb once one is readable, so an idle device costs
+ * no wake-ups at all. Elsewhere, or when libusb cannot export its fds, it waits
+ * inside libusb_handle_events_timeout_completed instead.
+ */
+class EventLoop {
+public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    explicit EventLoop(libusb_context* context);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /// Run task on the loop thread after delay (any thread, including transfer callbacks)
+    void post(Task task, Clock::duration delay = Clock::duration::zero());
+
+    /// Run task on the loop thread and wait for it (inline when already on it)
+    void runSync(const Task& task);
+
+    [[nodiscard]] bool inLoopThread() const;
+
+    /// Apply policy to the loop thread; rethrows applyThreadPolicy()'s error here
+    void setThreadPolicy(const ThreadPolicy& policy);
+
+    [[nodiscard]] libusb_context* getContext() const { return context; }
+
+private:
+    struct Timed {
+        Clock::time_point due;
+        uint64_t order;
+        Task task;
+    };
+
+    void run();
+    void runDue();
+    Clock::duration untilNextTask();
+
+    // Poller backend; pollerFd < 0 means libusb does the waiting
+    bool openPoller();
+    void closePoller();
+    void waitPoller(Clock::duration wait);
+    void wake();
+    LIBUSB_CALL static void pollfdAdded(int fd, short events, void* user);
+    LIBUSB_CALL static void pollfdRemoved(int fd, void* user);
+
+    libusb_context* context;
+    std::mutex mutex;
+    std::vector<Timed> tasks;
+    uint64_t posted = 0;
+    int pollerFd = -1;
+    int wakeRead = -1;   // eventfd on Linux (wakeRead == wakeWrite), pipe on macOS
+    int wakeWrite = -1;
+    std::atomic_bool running{true};
+    std::thread thread;
+};
+
+} // namespace xv
+
+#endif // XVISIO_EVENT_LOOP_H
@@ -7,17 +7,64 @@
 
 #include <libusb.h>
 #include <array>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <span>
+#include <vector>
 
 #define SET_REPORT 0x09
 #define GET_REPORT 0x01
 
 namespace xv {
+    class EventLoop;
+
+    /// Outcome of one HID command: SET_REPORT with the command, GET_REPORT with its echo and reply
+    struct HidResult {
+        int error = LIBUSB_SUCCESS;      ///< libusb error of either control transfer
+        bool acknowledged = false;       ///< device echoed the command back
+        std::array<uint8_t, 62> payload{};  ///< reply bytes after the echoed command
+        uint8_t size = 0;                ///< valid payload bytes (62 - command length)
+
+        [[nodiscard]] bool ok() const { return error == LIBUSB_SUCCESS && acknowledged; }
+    };
+
+    using HidCallback = std::function<void (const HidResult&)>;
+
+    /**
+     * HID command channel on interface 3.
+     *
+     * Commands are asynchronous control transfers completed on the EventLoop thread.
+     * The device holds one reply, so commands of a channel run one after another;
+     * a queued command is submitted from the previous one's completion, with no
+     * thread hand-off in between. Different devices proceed in parallel.
+     * The transfer and its queue live in a block the running command keeps alive,
+     * so a completion arriving after the HID is gone finds valid memory.
+     */
     class HID {
     public:
         static constexpr uint8_t reqLen = 63;
 
-        explicit HID(libusb_device_handle *handle);
+        HID(libusb_device_handle *handle, EventLoop *loop);
+
+        /// Fails the queued commands and cancels the running one, waiting (bounded) for it
+        ~HID();
+
+        HID(const HID&) = delete;
+        HID& operator=(const HID&) = delete;
+
+        /// Queue a command (at most 62 bytes). done runs on the event loop thread and must not block.
+        void submit(std::span<const uint8_t> command, HidCallback done, uint32_t timeout = 1000);
 
+        std::future<HidResult> submit(std::span<const uint8_t> command, uint32_t timeout = 1000);
+
+        /// Queue several commands back to back; results in the same order
+        std::vector<std::future<HidResult>> submitBatch(const std::vector<std::vector<uint8_t>> &commands,
+                                                        uint32_t timeout = 1000);
+
+        /// Blocking round trip; throws on libusb errors, false when the device did not acknowledge.
+        /// Not on the event loop thread, which completes it.
         template<size_t cmdLen>
         bool executeTransaction(std::array<uint8_t, cmdLen> &command, std::array<uint8_t, 62 - cmdLen> &data,
                                 uint32_t timeout = 1000);
@@ -25,12 +72,25 @@ namespace xv {
         void write(std::array<uint8_t, 64>& data, uint32_t timeout = 1000) const;
 
     private:
-        libusb_device_handle *handle;
+        struct Command {
+            std::array<uint8_t, reqLen> report{};  // 0x02 followed by the command bytes
+            uint8_t length = 0;
+            uint32_t timeout = 1000;
+            HidCallback done;
+        };
+
+        struct Channel;  // transfer, buffer and queue (hid.cpp)
 
+        HidResult transact(std::span<const uint8_t> command, uint32_t timeout);
+        Command makeCommand(std::span<const uint8_t> command, HidCallback done, uint32_t timeout) const;
+        void enqueue(std::vector<Command> commands);
+
+        libusb_device_handle *handle;
+        EventLoop *loop;
+        std::shared_ptr<Channel> channel;
     };
 }
 
 #include "hid_impl.h"
 
 #endif //LIBXVISIO_HID_H
-
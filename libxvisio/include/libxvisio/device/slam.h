@@ -8,19 +8,32 @@
 
 #include <vector>
 #include "libusb.h"
-#include "pose.h"
+#include "pose_hub.h"
+#include "run_flag.h"
+#include "thread_policy.h"
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <atomic>
-#include <thread>
 
 namespace xv {
-    using slamCallback = std::function<void (Pose)>;
-
     class Device;
+    class EventLoop;
+    struct SlamContext;
+
+    /// Where the last start() spent its time, measured from the start() call
+    struct StartupTiming {
+        std::chrono::microseconds configured{0};  ///< configure command acknowledged
+        std::chrono::microseconds ready{0};       ///< firmware answered the readiness probe
+        std::chrono::microseconds firstPose{0};   ///< first SLAM packet received (0: none yet)
+        int streamRequests = 0;                   ///< start-stream commands sent before the first packet
+    };
 
     class Slam {
     public:
-        Slam(Device* pDevice, libusb_context* libusbContext, libusb_device_handle* libusbDeviceHandle);
+        /// Transfers complete on eventLoop's thread, shared with every other device of the context
+        Slam(Device* pDevice, EventLoop* eventLoop, libusb_device_handle* libusbDeviceHandle);
 
         ~Slam();
 
@@ -39,27 +52,143 @@ namespace xv {
             Mixed
         };
 
-        void start(mode mode);
+        /// Configure the device and start streaming. Returns once the first pose arrived,
+        /// or after a few seconds without one (the stream keeps waiting; see getStartupTiming()).
+        /// @param inFlight Interrupt transfers kept queued on EP 0x83 (1-32); more tolerate host latency
+        void start(mode mode, uint8_t inFlight = 1);
 
         bool running() const;
         int getFrameCount() const;
 
+        /// Stream health (rate, jitter, latency, subscriber cost, errors, drops); lock-free,
+        /// callable from any thread while streaming. Counters restart with start().
+        [[nodiscard]] SlamMetrics getMetrics() const;
+
+        /// Startup breakdown of the current session; firstPose is the time-to-first-pose
+        [[nodiscard]] StartupTiming getStartupTiming() const;
+
+        /// Block until streaming ends (stop() or an unrecoverable USB error) or timeout passes.
+        /// Returns true once stopped.
+        bool waitUntilStopped(std::chrono::milliseconds timeout);
+
         void stop();
 
+        /// Survive unplugging: instead of stopping, wait for a device with the same UUID
+        /// to come back (via XVisio's hotplug handling), replay configure/start and
+        /// continue the same stream. running() stays true; subscribers only see a gap,
+        /// and timeUs continues across it. Set before start().
+        void setAutoReconnect(bool enabled) { autoReconnect = enabled; }
+
+        /// True while the device is gone and the stream waits for it
+        [[nodiscard]] bool reconnecting() const { return lost.load(); }
+
+        /// Times the stream resumed after losing its device
+        [[nodiscard]] int getReconnectCount() const { return reconnects.load(); }
+
+        /// Called by Device::reattach() with the returning device's handle
+        void resume(libusb_device_handle* newHandle);
+
+        /// Subscribers run on a dispatch thread fed by a ring, never on the USB event thread,
+        /// highest priority first. They may subscribe and unsubscribe while streaming; the
+        /// returned handle unsubscribes when destroyed.
+        ///
+        ///     auto subscription = slam->subscribe<&Renderer::onPose>(renderer);  // no allocation
+        ///     auto late = slam->subscribe<xv::RawPose>([](const xv::RawPose& raw) { ... }, 10);
+        template<auto Method, typename C>
+            requires std::is_member_function_pointer_v<decltype(Method)>
+        Subscription subscribe(C& object, int priority = 0) { return hub.subscribe<Method>(object, priority); }
+
+        template<auto Function>
+            requires std::is_pointer_v<decltype(Function)>
+        Subscription subscribe(int priority = 0) { return hub.subscribe<Function>(priority); }
+
+        template<typename T, typename F>
+        Subscription subscribe(F&& callable, int priority = 0) {
+            return hub.subscribe<T>(std::forward<F>(callable), priority);
+        }
+
+        /// Subscribe for the lifetime of the Slam
         void registerSlamCallback(const std::function<void(Pose pose)>&callback);
 
+        /// Like registerSlamCallback(), without the double-precision conversion; derive fields on demand.
+        void registerRawSlamCallback(const rawSlamCallback&callback);
+
+        /// Open a ring the USB thread publishes every decoded pose into.
+        /// The caller is its single consumer and may pull from any one thread. Open before start().
+        std::shared_ptr<PoseRing> openPoseRing();
+
+        /// Device/host clock correlation, updated with every packet.
+        /// clock().deviceToHost(pose.timeUs) is the host steady_clock ns the pose was sampled at.
+        [[nodiscard]] const ClockSync& clock() const;
+
+        /// Pose at host steady_clock time hostTimeNs (e.g. a vsync deadline), interpolated
+        /// between the two packets around it. Lock-free and allocation-free from any thread,
+        /// so a render thread needs no subscription. Holds the newest pose for later times;
+        /// nothing before the first pose or further back than ~130 ms.
+        [[nodiscard]] std::optional<Pose> sampleAt(int64_t hostTimeNs) const;
+
+        /// Accelerometer/gyro of every packet, scaled and bias-corrected with the
+        /// Device's ImuCalibration. Same dispatch thread as the pose callbacks; subscribe<&C::m>()
+        /// with an ImuSample parameter works too.
+        void registerImuCallback(const imuCallback&callback);
+
+        /// Like openPoseRing(), for IMU samples
+        std::shared_ptr<ImuRing> openImuRing();
+
+        /// See every raw EP 0x83 buffer before decoding (e.g. PacketRecorder).
+        /// Runs on the USB event thread and must not block. Register before start().
+        void registerPacketTap(const packetTap&tap);
+
+        /// Scheduling of the USB event thread that completes this stream's transfers (shared by
+        /// every device of the XVisio: the last call wins). Real-time priority and pinning keep
+        /// the 1 ms packet deadline when the rest of the system is loaded. Any time; throws
+        /// std::runtime_error naming the missing privilege (e.g. CAP_SYS_NICE for SCHED_FIFO).
+        void setThreadPolicy(const ThreadPolicy& policy);
+
+        /// Bounds of the validation stage. Packets with a bad length or header, a timestamp
+        /// that does not move forward, or an implausible jump never reach rings or subscribers;
+        /// getMetrics().rejectedPackets counts them. Set before start().
+        void setValidation(const ValidationOptions& options);
+
+        /// Decode-stage quaternion fix-up: unit length and no sign flips between consecutive
+        /// poses, so filters and interpolation downstream see a continuous rotation. The first
+        /// pose keeps its wire sign (identity arrives as w ≈ -1). Off by default; any thread, any time.
+        void setQuaternionConditioning(bool enabled);
+
+        /// One Euro smoothing of every pose at the device rate, before rings and subscribers
+        /// (packet taps still see raw packets). Off by default; any thread, any time.
+        void setSmoothing(const PoseFilterOptions& options);
+        [[nodiscard]] PoseFilterOptions getSmoothing() const;
+
+        /// Poses lost because the callback dispatch thread fell a full ring behind
+        [[nodiscard]] uint64_t getDroppedPoses() const;
+
     private:
-        void slamHandler();
+        /// Configure, probe, queue transfers and start the stream (start() and resume())
+        void bringUp(bool newSession);
+
+        // These run on the event loop thread
+        void startStreaming();
+        void teardown();
+        void deviceLost();
 
         LIBUSB_CALL static void usbCallback(libusb_transfer* transfer);
 
-        std::vector<slamCallback> callbacks;
+        PoseHub hub;
         Device* device;
         libusb_device_handle* handle;
-        std::thread slamThread;
-        std::atomic_bool runThread;
-        std::atomic<int> frameCount{0};
-        libusb_context* context;
+        EventLoop* loop;
+        std::shared_ptr<SlamContext> streaming;  // transfers of the current session, owned by the loop thread
+        RunFlag runThread;
+        mutable std::mutex timingMutex;  // guards startedAt and startup, written by bringUp()
+        std::chrono::steady_clock::time_point startedAt;
+        StartupTiming startup;
+        uint8_t transferDepth = 1;
+        mode slamMode = mode::Edge;
+        bool autoReconnect = false;
+        std::atomic_bool lost{false};
+        std::atomic<int> reconnects{0};
+        std::mutex lifecycle;  // serialises start(), stop() and resume()
     };
 } // xv
 
@@ -0,0 +1,112 @@
+/**
+ * @file packet_recording.h
+ * @brief Append-only recording of raw SLAM packets and its memory-mapped reader
+ *
+ * File layout: a sequence of CHUNK_SIZE chunks (the last one may be shorter).
+ * Each chunk is a 64-byte ChunkHeader followed by `count` fixed 80-byte
+ * PacketRecords. Integers are host (little-endian) order. A recording cut short
+ * by a crash stays readable up to the last completed record.
+ */
+
+#ifndef XVISIO_PACKET_RECORDING_H
+#define XVISIO_PACKET_RECORDING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xv {
+
+class Slam;
+
+namespace recording {
+    inline constexpr std::array<char, 4> MAGIC = {'X', 'V', 'R', 'C'};
+    inline constexpr uint16_t VERSION = 1;
+    inline constexpr size_t CHUNK_SIZE = 4 << 20;  // ~55 s of packets per chunk
+
+    struct ChunkHeader {
+        std::array<char, 4> magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t chunkIndex;
+        uint32_t count;          // records completed in this chunk
+        uint8_t reserved[48];
+    };
+
+    struct PacketRecord {
+        int64_t hostTimeNs;      // steady_clock at USB completion
+        uint8_t length;          // valid bytes in data
+        uint8_t reserved[7];
+        std::array<uint8_t, 64> data;
+    };
+
+    static_assert(sizeof(ChunkHeader) == 64 && sizeof(PacketRecord) == 80, "recording layout is fixed");
+
+    inline constexpr size_t RECORDS_PER_CHUNK = (CHUNK_SIZE - sizeof(ChunkHeader)) / sizeof(PacketRecord);
+}
+
+/**
+ * Writes packets into chunks mapped into memory, so appending is a memcpy.
+ * A new chunk (ftruncate + mmap) is mapped roughly once a minute.
+ * Throws std::runtime_error if the file cannot be created; later I/O failures stop
+ * the recording and are logged, since append() runs on the USB event thread.
+ */
+class PacketRecorder {
+public:
+    explicit PacketRecorder(const std::string& path);
+
+    /// Record every packet of a Slam stream (before Slam::start; must outlive the stream)
+    PacketRecorder(Slam& slam, const std::string& path);
+
+    ~PacketRecorder();
+
+    PacketRecorder(const PacketRecorder&) = delete;
+    PacketRecorder& operator=(const PacketRecorder&) = delete;
+
+    /// Writer: append one packet (one thread at a time)
+    void append(const uint8_t* packet, int length, int64_t hostTimeNs);
+
+    [[nodiscard]] uint64_t packets() const { return total; }
+
+private:
+    bool mapChunk();
+    void unmapChunk();
+
+    int fd = -1;
+    uint8_t* chunk = nullptr;  // current chunk mapping
+    uint32_t chunkIndex = 0;
+    uint64_t total = 0;
+    bool failed = false;
+};
+
+/// Read-only view of a recording, mapped in one piece
+class PacketRecording {
+public:
+    struct Packet {
+        int64_t hostTimeNs;
+        int length;
+        const uint8_t* data;  // 64 bytes, valid while the recording is open
+    };
+
+    /// Throws std::runtime_error if the file is missing or not a recording
+    explicit PacketRecording(const std::string& path);
+
+    ~PacketRecording();
+
+    PacketRecording(const PacketRecording&) = delete;
+    PacketRecording& operator=(const PacketRecording&) = delete;
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    [[nodiscard]] Packet operator[](size_t index) const;
+
+private:
+    const uint8_t* mapping = nullptr;
+    size_t mappedBytes = 0;
+    size_t count = 0;
+};
+
+} // namespace xv
+
+#endif // XVISIO_PACKET_RECORDING_H
@@ -0,0 +1,188 @@
+/**
+ * @file pose_log.h
+ * @brief Compact columnar pose log for long captures, and its memory-mapped reader
+ *
+ * File layout: a 64-byte FileHeader, then chunks of up to CHUNK_SAMPLES poses,
+ * then (once the writer is closed) an index of the chunks and a Trailer.
+ * A chunk is a 96-byte ChunkHeader followed by one byte stream per Column,
+ * back to back, padded to 8 bytes. Every value is a zigzag LEB128 varint of
+ * its difference from the previous sample in the chunk (the header holds the
+ * first sample), and time is stored as the difference of differences, so a
+ * steady 1 kHz stream takes about 1 byte per column per sample. Chunks decode
+ * on their own. A log cut short by a crash loses the chunk being filled; the
+ * reader rebuilds the index from the chunk headers. Integers are host
+ * (little-endian) order.
+ */
+
+#ifndef XVISIO_POSE_LOG_H
+#define XVISIO_POSE_LOG_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pose_hub.h"
+#include "raw_pose.h"
+
+namespace xv {
+
+class Slam;
+
+namespace poselog {
+    inline constexpr std::array<char, 4> MAGIC = {'X', 'V', 'P', 'L'};
+    inline constexpr std::array<char, 4> CHUNK_MAGIC = {'X', 'V', 'P', 'C'};
+    inline constexpr std::array<char, 4> INDEX_MAGIC = {'X', 'V', 'P', 'I'};
+    inline constexpr uint16_t VERSION = 1;
+    inline constexpr uint32_t CHUNK_SAMPLES = 4096;  // ~4 s at 1 kHz
+
+    /// One byte stream per field; time is unwrapped device µs, host time is µs after it
+    enum Column : uint8_t { Time = 0, X, Y, Z, QW, QX, QY, QZ, HostOffset, COLUMNS };
+
+    struct FileHeader {
+        std::array<char, 4> magic;
+        uint16_t version;
+        uint16_t columns;
+        uint32_t chunkSamples;
+        uint8_t reserved[52];
+    };
+
+    struct ChunkHeader {
+        std::array<char, 4> magic;
+        uint32_t count;                        // samples in this chunk
+        uint32_t payloadBytes;                 // column streams plus padding, after this header
+        uint32_t reserved0;
+        int64_t firstTimeUs;
+        int64_t lastTimeUs;
+        int64_t firstHostOffsetUs;             // host receive µs - device µs (sample 0)
+        std::array<int32_t, 3> firstTranslation;
+        std::array<int16_t, 4> firstQuaternion;
+        std::array<uint32_t, COLUMNS> columnBytes;
+    };
+
+    struct IndexEntry {
+        uint64_t offset;                       // of the ChunkHeader from the start of the file
+        uint32_t count;
+        uint32_t reserved;
+        int64_t firstTimeUs;
+        int64_t lastTimeUs;
+    };
+
+    struct Trailer {
+        std::array<char, 4> magic;
+        uint32_t chunks;
+        uint64_t indexOffset;                  // of the first IndexEntry
+        uint64_t samples;
+        uint64_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 64 && sizeof(ChunkHeader) == 96 && sizeof(IndexEntry) == 32 &&
+                  sizeof(Trailer) == 32, "pose log layout is fixed");
+}
+
+/**
+ * Encodes poses into chunks in memory and writes each full chunk with one write().
+ *
+ * Either feed it with append() from one thread, or let it follow() a pose ring,
+ * which a background thread drains so the stream threads only pay for the ring
+ * push. The index is written on destruction. Throws std::runtime_error if the file
+ * cannot be created; later write failures stop the log and are logged.
+ */
+class PoseLogWriter {
+public:
+    explicit PoseLogWriter(const std::string& path);
+
+    /// Log every pose of a Slam stream from a background thread (before Slam::start)
+    PoseLogWriter(Slam& slam, const std::string& path);
+
+    ~PoseLogWriter();
+
+    PoseLogWriter(const PoseLogWriter&) = delete;
+    PoseLogWriter& operator=(const PoseLogWriter&) = delete;
+
+    /// Drain ring on the background thread from now on, after what is left in the previous one
+    /// (e.g. a new Slam session's Slam::openPoseRing())
+    void follow(std::shared_ptr<PoseRing> ring);
+
+    /// Writer: encode one pose (one thread at a time, and not while following a ring)
+    void append(const RawPose& pose);
+
+    [[nodiscard]] uint64_t samples() const { return total.load(std::memory_order_relaxed); }
+
+    /// File bytes so far, the chunk being filled excluded
+    [[nodiscard]] uint64_t bytes() const { return written.load(std::memory_order_relaxed); }
+
+private:
+    void flushChunk();
+    bool writeAll(const void* data, size_t length);
+    void drain();
+
+    int fd = -1;
+    bool failed = false;
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> written{0};
+
+    // Chunk being filled
+    poselog::ChunkHeader header{};
+    std::array<std::vector<uint8_t>, poselog::COLUMNS> columns;
+    RawPose previous;
+    int64_t previousDeltaUs = 0;
+    int64_t previousHostOffsetUs = 0;
+    std::vector<poselog::IndexEntry> index;
+
+    // Background drain
+    std::mutex ringMutex;
+    std::condition_variable ringChanged;
+    std::shared_ptr<PoseRing> nextRing;
+    std::atomic_bool stopping{false};
+    std::thread drainer;
+};
+
+/**
+ * Read-only view of a pose log, mapped in one piece. Chunks are decoded on demand;
+ * all members are const and safe to call from several threads. Time lookups
+ * assume time does not go backwards, which holds within a Slam session.
+ */
+class PoseLog {
+public:
+    /// Throws std::runtime_error if the file is missing or not a pose log
+    explicit PoseLog(const std::string& path);
+
+    ~PoseLog();
+
+    PoseLog(const PoseLog&) = delete;
+    PoseLog& operator=(const PoseLog&) = delete;
+
+    [[nodiscard]] uint64_t size() const { return samples; }
+    [[nodiscard]] size_t chunks() const { return index.size(); }
+    [[nodiscard]] const poselog::IndexEntry& chunk(size_t i) const { return index[i]; }
+
+    /// Every pose of chunk i, appended to out. Decoded poses carry timeUs, hostTimeNs (to the µs),
+    /// translation and quaternion; timestamp is the low 32 bits of timeUs; IMU fields are zero.
+    void read(size_t i, std::vector<RawPose>& out) const;
+
+    /// Poses with fromUs <= timeUs < toUs
+    [[nodiscard]] std::vector<RawPose> range(int64_t fromUs, int64_t toUs) const;
+
+    /// Newest pose at or before timeUs; nullopt before the first
+    [[nodiscard]] std::optional<RawPose> at(int64_t timeUs) const;
+
+private:
+    /// Poses of chunk i up to and including untilUs
+    void decode(size_t i, int64_t untilUs, std::vector<RawPose>& out) const;
+
+    const uint8_t* mapping = nullptr;
+    size_t mappedBytes = 0;
+    std::vector<poselog::IndexEntry> index;
+    uint64_t samples = 0;
+};
+
+} // namespace xv
+
+#endif // XVISIO_POSE_LOG_H
@@ -0,0 +1,98 @@
+/**
+ * @file replay_slam.h
+ * @brief Plays a packet recording through the same decode and dispatch path as Slam
+ */
+
+#ifndef XVISIO_REPLAY_SLAM_H
+#define XVISIO_REPLAY_SLAM_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "packet_recording.h"
+#include "pose_hub.h"
+
+namespace xv {
+
+/**
+ * Stand-in for Slam that needs no hardware.
+ *
+ * Packets keep their recorded spacing, scaled by the replay speed; host times are
+ * rebased onto the replay's own steady_clock timeline so clock().deviceToHost()
+ * stays meaningful. At speed 0 (as fast as possible) each packet is stamped with
+ * the time it is published instead, and the replay waits for the callback dispatch
+ * thread rather than dropping, so every callback sees every packet.
+ */
+class ReplaySlam {
+public:
+    /// Throws std::runtime_error if the recording cannot be opened
+    explicit ReplaySlam(const std::string& path);
+
+    ~ReplaySlam();
+
+    ReplaySlam(const ReplaySlam&) = delete;
+    ReplaySlam& operator=(const ReplaySlam&) = delete;
+
+    /// Start playback: 1 = real time, N = N× speed, 0 = as fast as possible
+    void start(double speed = 1.0);
+
+    /// False once every packet has been published (or after stop())
+    bool running() const;
+    int getFrameCount() const;
+
+    /// Stop playback and drain the callbacks
+    void stop();
+
+    /// Same as Slam::subscribe()
+    template<auto Method, typename C>
+        requires std::is_member_function_pointer_v<decltype(Method)>
+    Subscription subscribe(C& object, int priority = 0) { return hub.subscribe<Method>(object, priority); }
+
+    template<auto Function>
+        requires std::is_pointer_v<decltype(Function)>
+    Subscription subscribe(int priority = 0) { return hub.subscribe<Function>(priority); }
+
+    template<typename T, typename F>
+    Subscription subscribe(F&& callable, int priority = 0) {
+        return hub.subscribe<T>(std::forward<F>(callable), priority);
+    }
+
+    void registerSlamCallback(const slamCallback& callback);
+    void registerRawSlamCallback(const rawSlamCallback& callback);
+    void registerImuCallback(const imuCallback& callback);
+    void registerPacketTap(const packetTap& tap);
+    std::shared_ptr<PoseRing> openPoseRing();
+    std::shared_ptr<ImuRing> openImuRing();
+
+    /// Applied to the IMU stream; set before start()
+    void setImuCalibration(const ImuCalibration& calibration);
+
+    /// Same as Slam::setValidation(), Slam::setQuaternionConditioning() and Slam::setSmoothing()
+    void setValidation(const ValidationOptions& options);
+    void setQuaternionConditioning(bool enabled);
+    void setSmoothing(const PoseFilterOptions& options);
+    [[nodiscard]] PoseFilterOptions getSmoothing() const;
+
+    [[nodiscard]] const ClockSync& clock() const;
+    /// Same as Slam::sampleAt(); replayed packets are stamped with the steady_clock time they are published
+    [[nodiscard]] std::optional<Pose> sampleAt(int64_t hostTimeNs) const;
+    [[nodiscard]] uint64_t getDroppedPoses() const;
+    /// Like Slam::getMetrics(); transport fields stay zero
+    [[nodiscard]] SlamMetrics getMetrics() const;
+
+    /// Packets in the recording
+    [[nodiscard]] size_t size() const;
+
+private:
+    void replayHandler(double speed);
+
+    PacketRecording recording;
+    PoseHub hub;
+    std::thread replayThread;
+    std::atomic_bool runThread{false};
+};
+
+} // namespace xv
+
+#endif // XVISIO_REPLAY_SLAM_H
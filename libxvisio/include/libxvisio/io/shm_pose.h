@@ -0,0 +1,123 @@
+/**
+ * @file shm_pose.h
+ * @brief Shared-memory pose and fused-sample segment layouts and their header-only readers
+ *
+ * Include this header (and link -lrt on older glibc) to read poses published by
+ * ShmPosePublisher, or fused samples published by ShmFusionPublisher, from any
+ * process; libxvisio itself is not needed. Reads are plain loads from the mapping:
+ * no syscalls and no locks.
+ */
+
+#ifndef XVISIO_SHM_POSE_H
+#define XVISIO_SHM_POSE_H
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fused_sample.h"
+#include "pose.h"
+#include "seq_ring.h"
+
+namespace xv {
+
+inline constexpr const char* SHM_POSE_DEFAULT_NAME = "/xvisio_pose";
+inline constexpr uint32_t SHM_POSE_MAGIC = 0x53505658;  // "XVPS"
+inline constexpr uint32_t SHM_POSE_VERSION = 1;
+inline constexpr size_t SHM_POSE_CAPACITY = 256;        // ~270 ms at 950 Hz
+
+inline constexpr const char* SHM_FUSION_DEFAULT_NAME = "/xvisio_fusion";
+inline constexpr uint32_t SHM_FUSION_MAGIC = 0x53465658;  // "XVFS"
+inline constexpr uint32_t SHM_FUSION_VERSION = 1;
+inline constexpr size_t SHM_FUSION_CAPACITY = 64;         // ~270 ms of two hands at 120 Hz
+
+struct SharedPose {
+    Pose pose;               ///< timestamp is device µs (RawPose::timeUs)
+    int64_t hostTimeNs = 0;  ///< Host steady_clock (CLOCK_MONOTONIC) ns the pose was sampled at
+};
+
+/// Segment layout; the writer sets magic last, once everything else is initialized
+template<typename T, uint32_t Magic, uint32_t Version, size_t Capacity>
+struct ShmSegment {
+    using Item = T;
+    static constexpr uint32_t MAGIC = Magic;
+    static constexpr uint32_t VERSION = Version;
+    static constexpr size_t CAPACITY = Capacity;
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t itemSize;
+    alignas(64) SeqRing<T, Capacity> ring;
+
+    [[nodiscard]] bool compatible() const {
+        return magic.load(std::memory_order_acquire) == Magic && version == Version &&
+               capacity == Capacity && itemSize == sizeof(T);
+    }
+};
+
+using ShmPoseSegment = ShmSegment<SharedPose, SHM_POSE_MAGIC, SHM_POSE_VERSION, SHM_POSE_CAPACITY>;
+using ShmFusionSegment = ShmSegment<FusedSample, SHM_FUSION_MAGIC, SHM_FUSION_VERSION, SHM_FUSION_CAPACITY>;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be address-free");
+
+/**
+ * Read-only view of a publisher's segment. Any number of readers, in any process.
+ * The segment outlives publisher restarts, so an open reader keeps working across them.
+ */
+template<typename Segment>
+class ShmRingReader {
+public:
+    using Item = typename Segment::Item;
+
+    explicit ShmRingReader(const std::string& name) {
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) throw std::runtime_error("No publisher at " + name);
+        struct stat info{};
+        const bool sized = fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(Segment));
+        void* mapping = sized ? mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (mapping == MAP_FAILED) throw std::runtime_error("Cannot map segment " + name);
+        segment = static_cast<const Segment*>(mapping);
+        if (!segment->compatible()) {
+            munmap(mapping, sizeof(Segment));
+            throw std::runtime_error("Incompatible or uninitialized segment " + name);
+        }
+    }
+
+    ~ShmRingReader() { munmap(const_cast<Segment*>(segment), sizeof(Segment)); }
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    /// Items ever published; poll this to detect new data
+    [[nodiscard]] uint64_t count() const { return segment->ring.count(); }
+
+    bool latest(Item& out) const { return segment->ring.latest(out); }
+
+    /// Up to max most recent items, oldest first
+    size_t readRecent(Item* out, size_t max) const { return segment->ring.readRecent(out, max); }
+
+private:
+    const Segment* segment = nullptr;
+};
+
+/// Poses of a ShmPosePublisher
+class ShmPoseReader : public ShmRingReader<ShmPoseSegment> {
+public:
+    explicit ShmPoseReader(const std::string& name = SHM_POSE_DEFAULT_NAME) : ShmRingReader(name) {}
+};
+
+/// Fused samples of a ShmFusionPublisher, in fusion order across all tracked objects
+class ShmFusionReader : public ShmRingReader<ShmFusionSegment> {
+public:
+    explicit ShmFusionReader(const std::string& name = SHM_FUSION_DEFAULT_NAME) : ShmRingReader(name) {}
+};
+
+} // namespace xv
+
+#endif // XVISIO_SHM_POSE_H
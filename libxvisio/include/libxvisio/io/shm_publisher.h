@@ -0,0 +1,74 @@
+/**
+ * @file shm_publisher.h
+ * @brief Publishes poses and fused samples into POSIX shared-memory rings for same-host consumers
+ */
+
+#ifndef XVISIO_SHM_PUBLISHER_H
+#define XVISIO_SHM_PUBLISHER_H
+
+#include <string>
+#include "raw_pose.h"
+#include "shm_pose.h"
+#include "subscription.h"
+
+namespace xv {
+
+class Slam;
+class PoseFusion;
+
+/**
+ * Single writer of a shared pose segment (read with ShmPoseReader).
+ *
+ * A compatible existing segment is reused and its sequence continued, so readers
+ * survive publisher restarts; the segment persists until unlinked (/dev/shm on Linux).
+ * Throws std::runtime_error if the segment cannot be created.
+ */
+class ShmPosePublisher {
+public:
+    explicit ShmPosePublisher(const std::string& name = SHM_POSE_DEFAULT_NAME);
+
+    /// Publish every pose of a Slam stream from its dispatch thread, until destroyed.
+    /// The Slam must outlive the publisher.
+    explicit ShmPosePublisher(Slam& slam, const std::string& name = SHM_POSE_DEFAULT_NAME);
+
+    ~ShmPosePublisher();
+
+    ShmPosePublisher(const ShmPosePublisher&) = delete;
+    ShmPosePublisher& operator=(const ShmPosePublisher&) = delete;
+
+    /// Writer: publish one pose (one thread at a time)
+    void publish(const Pose& pose, int64_t hostTimeNs);
+
+    /// Remove the segment name; open readers keep their mapping
+    static void unlink(const std::string& name = SHM_POSE_DEFAULT_NAME);
+
+private:
+    ShmPoseSegment* segment = nullptr;
+    Subscription subscription;  // reset before the segment is unmapped
+};
+
+/// Single writer of a shared fused-sample segment (read with ShmFusionReader); same lifetime rules
+class ShmFusionPublisher {
+public:
+    explicit ShmFusionPublisher(const std::string& name = SHM_FUSION_DEFAULT_NAME);
+
+    /// Publish every sample of a PoseFusion from its pushing thread, until destroyed.
+    /// The PoseFusion must outlive the publisher.
+    explicit ShmFusionPublisher(PoseFusion& fusion, const std::string& name = SHM_FUSION_DEFAULT_NAME);
+
+    ~ShmFusionPublisher();
+
+    ShmFusionPublisher(const ShmFusionPublisher&) = delete;
+    ShmFusionPublisher& operator=(const ShmFusionPublisher&) = delete;
+
+    /// Writer: publish one sample (one thread at a time)
+    void publish(const FusedSample& sample);
+
+private:
+    ShmFusionSegment* segment = nullptr;
+    Subscription subscription;  // reset before the segment is unmapped
+};
+
+} // namespace xv
+
+#endif // XVISIO_SHM_PUBLISHER_H
@@ -0,0 +1,93 @@
+/**
+ * @file clock_sync.h
+ * @brief Edge timestamp unwrapping and device-to-host clock correlation
+ */
+
+#ifndef XVISIO_CLOCK_SYNC_H
+#define XVISIO_CLOCK_SYNC_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "seq_ring.h"
+
+namespace xv {
+
+/**
+ * Maps the device's 32-bit µs edge counter onto host steady_clock.
+ *
+ * The counter is unwrapped into a monotonic int64. Every packet contributes
+ * (device time, host receive time); the fastest packet of each 500 ms bucket is
+ * the one least delayed by USB and scheduling, so a linear regression through
+ * those minima gives offset and drift. Latency is the delay of a packet relative
+ * to that fit, i.e. transport delay above the fastest path observed; it can dip
+ * slightly below zero between minima. A jump of more than a second (device
+ * restart) discards the history and starts a new fit.
+ *
+ * Fed by one thread (the USB event thread); conversions may be called from any thread.
+ */
+class ClockSync {
+public:
+    /// Writer: extend a raw edge timestamp to monotonic device µs
+    int64_t unwrap(uint32_t timestamp);
+
+    /// Writer: like unwrap(), for the first packet after the device restarted its counter.
+    /// Continues the count where the current fit puts hostTimeNs, so timeUs and the
+    /// fit carry on across a reconnect.
+    int64_t rebase(uint32_t timestamp, int64_t hostTimeNs);
+
+    /// Writer: record one packet's device time and host receive time (steady_clock ns)
+    void observe(int64_t deviceTimeUs, int64_t hostTimeNs);
+
+    /// Host steady_clock ns at which the device clock read deviceTimeUs (0 before the first packet)
+    [[nodiscard]] int64_t deviceToHost(int64_t deviceTimeUs) const;
+
+    /// Device µs at host steady_clock time hostTimeNs (0 before the first packet)
+    [[nodiscard]] int64_t hostToDevice(int64_t hostTimeNs) const;
+
+    /// Transport latency of a packet in ns, relative to the fitted clock
+    [[nodiscard]] int64_t latency(int64_t deviceTimeUs, int64_t hostTimeNs) const;
+
+    /// Latency of the most recent packet in ns
+    [[nodiscard]] int64_t lastLatency() const { return lastLatencyNs.load(std::memory_order_relaxed); }
+
+    /// Device clock rate error against host in parts per million
+    [[nodiscard]] double driftPpm() const;
+
+    /// True once at least one packet has been observed
+    [[nodiscard]] bool synced() const { return estimates.count() > 0; }
+
+private:
+    /// host = hostRefNs + (device - deviceRefUs) * 1000 * (1 + drift)
+    struct Estimate {
+        int64_t deviceRefUs;
+        int64_t hostRefNs;
+        double drift;
+    };
+
+    struct Minimum {
+        int64_t deviceTimeUs;
+        int64_t offsetNs;  // host ns - device µs * 1000
+    };
+
+    static constexpr size_t MAX_BUCKETS = 64;  // ~32 s of history
+
+    void restart();
+    void publish();
+
+    SeqRing<Estimate, 4> estimates;
+    std::atomic<int64_t> lastLatencyNs{0};
+
+    // Writer-only state
+    uint32_t lastTimestamp = 0;
+    int64_t unwrappedUs = -1;
+    std::array<Minimum, MAX_BUCKETS> buckets{};
+    size_t bucketCount = 0;
+    size_t bucketHead = 0;  // index of the oldest closed bucket
+    Minimum current{};
+    int64_t currentStartUs = -1;
+};
+
+} // namespace xv
+
+#endif // XVISIO_CLOCK_SYNC_H
@@ -0,0 +1,63 @@
+/**
+ * @file packet_validator.h
+ * @brief Keeps short, garbled and implausible packets away from the subscribers
+ */
+
+#ifndef XVISIO_PACKET_VALIDATOR_H
+#define XVISIO_PACKET_VALIDATOR_H
+
+#include <cstdint>
+#include "raw_pose.h"
+#include "stream_metrics.h"
+
+namespace xv {
+
+struct ValidationOptions {
+    double maxSpeed = 20.0;          ///< m/s between consecutive poses; 0 = no translation bound
+    double maxAngularSpeed = 40.0;   ///< rad/s between consecutive poses; 0 = no rotation bound
+    int64_t maxStepUs = 2000000;     ///< Largest forward timestamp step taken as the same stream
+    int maxConsecutive = 8;          ///< Accept the next one after this many rejections in a row
+    bool substitute = false;         ///< Publish a constant-velocity prediction in place of a motion outlier
+};
+
+/**
+ * Producer-side validation of every EP 0x83 buffer.
+ *
+ * The packet check (length and 01 A2 33 header) is two compares. The pose check
+ * compares the edge timestamp and the motion since the last accepted pose
+ * against the bounds. A run of maxConsecutive rejections is taken as a real
+ * discontinuity (relocalization, counter reset), and the next pose is accepted
+ * as the new reference. Every rejection is counted in the StreamMetrics.
+ */
+class PacketValidator {
+public:
+    explicit PacketValidator(StreamMetrics& metrics) : metrics(metrics) {}
+
+    /// Set before streaming starts
+    void setOptions(const ValidationOptions& next) { options = next; }
+
+    /// Length and header; false (and counted) for anything that is not a SLAM packet
+    bool admit(const uint8_t* packet, int length);
+
+    /// Timestamp and motion of a decoded pose, before unwrapping. False to drop it; with
+    /// substitute set, a motion outlier is overwritten with a prediction and admitted.
+    bool admit(RawPose& pose);
+
+    /// Take the next pose as the reference unchecked (new session, device restart)
+    void restart() { references = 0; }
+
+private:
+    bool plausibleMotion(const RawPose& pose, double dt) const;
+    bool accept(const RawPose& pose);
+
+    StreamMetrics& metrics;
+    ValidationOptions options;
+    RawPose previous;   // accepted before last, for the substitute's velocity
+    RawPose last;       // last accepted
+    int references = 0; // accepted poses held in previous/last (0-2)
+    int rejectedInRow = 0;
+};
+
+} // namespace xv
+
+#endif // XVISIO_PACKET_VALIDATOR_H
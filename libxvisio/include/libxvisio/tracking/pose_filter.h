@@ -0,0 +1,123 @@
+/**
+ * @file pose_filter.h
+ * @brief One Euro smoothing of the full-rate pose stream
+ */
+
+#ifndef XVISIO_POSE_FILTER_H
+#define XVISIO_POSE_FILTER_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <numbers>
+#include "pose.h"
+#include "raw_pose.h"
+#include "seq_ring.h"
+
+namespace xv {
+
+/// One Euro parameters (Casiez et al. 2012); units follow the filtered value
+struct OneEuroParams {
+    double minCutoff = 1.0;         ///< Hz at rest; lower removes more jitter
+    double beta = 0.0;              ///< Cutoff added per unit/s of speed; higher removes more lag
+    double derivativeCutoff = 1.0;  ///< Hz of the low-pass on the speed estimate
+};
+
+namespace detail {
+    /// Exponential smoothing factor of a first-order low-pass at cutoffHz sampled every dt seconds
+    inline double smoothingFactor(double cutoffHz, double dt) {
+        const double r = 2.0 * std::numbers::pi * cutoffHz * dt;
+        return r / (r + 1.0);
+    }
+}
+
+/// One Euro filter over N independent components, each adapting its own cutoff to its speed
+template<size_t N>
+class OneEuroFilter {
+public:
+    using Value = std::array<double, N>;
+
+    /// Filter a sample taken dt seconds after the previous one; the first passes through
+    Value operator()(const Value& value, double dt, const OneEuroParams& params) {
+        if (!primed) {
+            filtered = value;
+            speed = {};
+            primed = true;
+        } else if (dt > 0.0) {
+            const double speedAlpha = detail::smoothingFactor(params.derivativeCutoff, dt);
+            for (size_t i = 0; i < N; ++i) {
+                speed[i] += speedAlpha * ((value[i] - filtered[i]) / dt - speed[i]);
+                const double cutoff = params.minCutoff + params.beta * std::abs(speed[i]);
+                filtered[i] += detail::smoothingFactor(cutoff, dt) * (value[i] - filtered[i]);
+            }
+        }
+        return filtered;
+    }
+
+    void reset() { primed = false; }
+
+private:
+    Value filtered{};
+    Value speed{};
+    bool primed = false;
+};
+
+/// One Euro on a rotation: slerp toward each new quaternion by the adaptive factor,
+/// with the angular speed (rad/s) in place of the per-component speed
+class RotationFilter {
+public:
+    Vector4 operator()(const Vector4& value, double dt, const OneEuroParams& params);
+
+    void reset() { primed = false; }
+
+private:
+    Vector4 filtered{1.0, 0.0, 0.0, 0.0};
+    double speed = 0.0;
+    bool primed = false;
+};
+
+struct PoseFilterOptions {
+    bool enabled = false;
+    OneEuroParams position{1.0, 4.0, 1.0};  ///< Meters: beta per m/s
+    OneEuroParams rotation{1.0, 0.3, 1.0};  ///< Radians: beta per rad/s
+};
+
+/**
+ * Smooths poses at the device rate: One Euro per position axis, adaptive slerp for
+ * orientation.
+ *
+ * The result keeps RawPose's fixed-point encoding, so rings, records and subscribers
+ * downstream carry it unchanged. State restarts after a gap in the stream or when
+ * re-enabled. apply() runs on one thread (the producer); setOptions() may be called
+ * from any thread and takes effect with the next sample.
+ */
+class PoseFilter {
+public:
+    using Options = PoseFilterOptions;
+
+    explicit PoseFilter(Options options = {});
+
+    /// Smooth translation and quaternion in place (no-op while disabled)
+    void apply(RawPose& pose);
+
+    void setOptions(const Options& options);
+    [[nodiscard]] Options getOptions() const;
+
+private:
+    void reset();
+
+    Options active;
+    uint64_t activeVersion = 0;
+    int64_t lastTimeUs = 0;
+    OneEuroFilter<3> positionFilter;
+    RotationFilter rotationFilter;
+
+    std::mutex writer;              // setters only; apply() never locks
+    SeqRing<Options, 4> settings;   // newest is the current setting
+};
+
+} // namespace xv
+
+#endif // XVISIO_POSE_FILTER_H
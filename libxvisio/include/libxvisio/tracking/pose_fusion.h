@@ -0,0 +1,101 @@
+/**
+ * @file pose_fusion.h
+ * @brief Time alignment of external trackers with the XR50 pose history, and their world-frame placement
+ */
+
+#ifndef XVISIO_POSE_FUSION_H
+#define XVISIO_POSE_FUSION_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "clock_sync.h"
+#include "fused_sample.h"
+#include "pose.h"
+#include "spsc_ring.h"
+#include "subscription.h"
+
+namespace xv {
+
+/// Rigid mount of an external tracker on the headset, in the XR50 body frame
+struct Extrinsics {
+    Vector3 translation{};                 ///< Tracker origin, meters
+    Vector4 rotation{1.0, 0.0, 0.0, 0.0};  ///< Tracker axes, W, X, Y, Z
+};
+
+/// sample in the world frame: head * mount * sample, stamped with the head pose's device time.
+/// mount.rotation must be unit length (addSource() normalizes it).
+FusedSample fuse(const ExternalSample& sample, const Extrinsics& mount, const Pose& head);
+
+/// ~2 s of two hands at 120 Hz
+using FusedRing = SpscRing<FusedSample, 512>;
+
+/**
+ * Places samples of head-mounted trackers (hands, controllers) in the XR50 world.
+ *
+ * Each source's clock is fitted against host receive times with its own ClockSync,
+ * the same min-filtered regression that maps the XR50 clock, so a sample is stamped
+ * with when it was captured rather than when it arrived. The head pose at that
+ * instant comes from the XR50 history (Slam::sampleAt), which reaches back ~135 ms.
+ *
+ * push() runs on one thread at a time; addSource() and rings are set up before the
+ * first push, callbacks may come and go at any time. Counters may be read from any thread.
+ */
+class PoseFusion {
+public:
+    /// XR50 pose at host steady_clock ns, its timestamp the device µs (Slam::sampleAt)
+    using HeadSampler = std::function<std::optional<Pose> (int64_t hostTimeNs)>;
+    using FusedCallback = std::function<void (const FusedSample&)>;
+
+    static constexpr size_t MAX_SOURCES = 8;
+
+    explicit PoseFusion(HeadSampler head);
+
+    /// Follow a Slam or ReplaySlam, which must outlive the fusion
+    template<typename S>
+        requires requires(const S& slam) { slam.sampleAt(int64_t{}); }
+    explicit PoseFusion(const S& slam)
+        : PoseFusion(HeadSampler([&slam](int64_t hostTimeNs) { return slam.sampleAt(hostTimeNs); })) {}
+
+    /// Register a tracker; returns the ExternalSample::source to tag its samples with
+    uint16_t addSource(const Extrinsics& mount = {});
+
+    /// Ring every fused sample is pushed into; its single consumer may be on any thread
+    std::shared_ptr<FusedRing> openFusedRing();
+
+    /// Called on the pushing thread with every fused sample until the Subscription is reset
+    /// (which waits out a running call); must not block. release() keeps it for good.
+    Subscription registerFusedCallback(const FusedCallback& callback, int priority = 0);
+
+    /// Align, transform and publish one sample. False (and counted) when there is no
+    /// head pose at its capture time or its source is unknown.
+    bool push(const ExternalSample& sample);
+
+    [[nodiscard]] uint64_t fused() const { return fusedCount.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t unaligned() const { return unalignedCount.load(std::memory_order_relaxed); }
+
+    /// Source receive delay above its fastest path, in ns of the latest sample (ClockSync::lastLatency)
+    [[nodiscard]] int64_t sourceLatency(uint16_t source) const;
+
+private:
+    struct Source {
+        Extrinsics mount;
+        ClockSync clock;
+    };
+
+    HeadSampler head;
+    std::array<Source, MAX_SOURCES> sources;
+    size_t sourceCount = 0;
+    std::vector<std::shared_ptr<FusedRing>> rings;
+    std::shared_ptr<SubscriberTable> subscribers = std::make_shared<SubscriberTable>();
+    std::atomic<uint64_t> fusedCount{0};
+    std::atomic<uint64_t> unalignedCount{0};
+};
+
+} // namespace xv
+
+#endif // XVISIO_POSE_FUSION_H
@@ -0,0 +1,43 @@
+/**
+ * @file pose_history.h
+ * @brief Recent poses, sampled at an arbitrary time by lock-free readers
+ */
+
+#ifndef XVISIO_POSE_HISTORY_H
+#define XVISIO_POSE_HISTORY_H
+
+#include <cstdint>
+#include <optional>
+#include "pose.h"
+#include "raw_pose.h"
+#include "seq_ring.h"
+
+namespace xv {
+
+/**
+ * The last ~135 ms of poses (128 at 950 Hz), interpolated on demand.
+ *
+ * Written by the producer with every pose; at() may be called from any number of
+ * threads and never blocks or allocates. Queries near the newest pose, the usual
+ * case for a render thread, touch two or three slots.
+ */
+class PoseHistory {
+public:
+    /// Writer: append a pose (timeUs must not go backwards within a stream)
+    void push(const RawPose& pose) { poses.push(pose); }
+
+    /// Pose at deviceTimeUs: position lerped and quaternion slerped between the two
+    /// bracketing poses. Clamped to the newest pose past the end (use PosePredictor to
+    /// look ahead); nothing before the first pose or older than the history.
+    [[nodiscard]] std::optional<Pose> at(int64_t deviceTimeUs) const;
+
+    /// Newest pose without conversion; false before the first one
+    bool latest(RawPose& out) const { return poses.latest(out); }
+
+private:
+    SeqRing<RawPose, 128> poses;
+};
+
+} // namespace xv
+
+#endif // XVISIO_POSE_HISTORY_H
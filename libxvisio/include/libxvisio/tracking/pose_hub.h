@@ -0,0 +1,162 @@
+/**
+ * @file pose_hub.h
+ * @brief Packet decode and pose fan-out shared by live and replayed streams
+ */
+
+#ifndef XVISIO_POSE_HUB_H
+#define XVISIO_POSE_HUB_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "clock_sync.h"
+#include "imu_sample.h"
+#include "pose.h"
+#include "pose_filter.h"
+#include "packet_validator.h"
+#include "pose_history.h"
+#include "raw_pose.h"
+#include "spsc_ring.h"
+#include "stream_metrics.h"
+#include "subscription.h"
+
+namespace xv {
+    using slamCallback = std::function<void (Pose)>;
+    using rawSlamCallback = std::function<void (const RawPose&)>;
+    using imuCallback = std::function<void (const ImuSample&)>;
+
+    /// Raw endpoint buffer plus its host receive time (steady_clock ns), seen before decoding
+    using packetTap = std::function<void (const uint8_t* packet, int length, int64_t hostTimeNs)>;
+
+    /// ~1 s of poses at the device's ~950 Hz
+    using PoseRing = SpscRing<RawPose, 1024>;
+    using ImuRing = SpscRing<ImuSample, 1024>;
+
+    /**
+     * Decodes packets on the producer thread and hands poses to rings and callbacks.
+     *
+     * The producer (USB event thread or replay thread) calls publish(); subscribers run on
+     * a dispatch thread fed by a ring and may come and go while streaming. Taps and rings
+     * are fixed before startDispatch().
+     */
+    class PoseHub {
+    public:
+        ~PoseHub();
+
+        /// Call object.*Method with every RawPose, Pose or ImuSample (picked from its parameter)
+        template<auto Method, typename C>
+            requires std::is_member_function_pointer_v<decltype(Method)>
+        Subscription subscribe(C& object, int priority = 0) {
+            using T = detail::SubscriberArgOf<Method>;
+            return subscribers->add(Subscriber<T>::template member<Method>(object, priority));
+        }
+
+        /// Call a free function with every RawPose, Pose or ImuSample
+        template<auto Function>
+            requires std::is_pointer_v<decltype(Function)>
+        Subscription subscribe(int priority = 0) {
+            using T = detail::SubscriberArgOf<Function>;
+            return subscribers->add(Subscriber<T>::template function<Function>(priority));
+        }
+
+        /// Call a copy of callable with every T (RawPose, Pose or ImuSample); the copy lives on the heap
+        template<typename T, typename F>
+        Subscription subscribe(F&& callable, int priority = 0) {
+            return subscribers->add(Subscriber<T>::callable(std::forward<F>(callable), priority));
+        }
+
+        /// Subscribe for the lifetime of the hub
+        void registerSlamCallback(const slamCallback& callback);
+        void registerRawSlamCallback(const rawSlamCallback& callback);
+        void registerImuCallback(const imuCallback& callback);
+        void registerPacketTap(const packetTap& tap);
+        std::shared_ptr<PoseRing> openPoseRing();
+        std::shared_ptr<ImuRing> openImuRing();
+
+        /// Applied to every IMU sample; set before startDispatch()
+        void setImuCalibration(const ImuCalibration& calibration) { imuCalibration = calibration; }
+
+        /// Bounds for rejecting corrupted and implausible packets; set before startDispatch()
+        void setValidation(const ValidationOptions& options) { validator.setOptions(options); }
+
+        /// Renormalize every decoded quaternion and keep consecutive ones in the same
+        /// hemisphere (RawPose::conditionQuaternion); any thread, any time
+        void setQuaternionConditioning(bool enabled) { conditionQuaternions = enabled; }
+
+        /// Smoothing applied to every pose before rings and subscribers see it; any thread, any time
+        void setSmoothing(const PoseFilterOptions& options) { smoothing.setOptions(options); }
+        [[nodiscard]] PoseFilterOptions getSmoothing() const { return smoothing.getOptions(); }
+
+        /// Launch the callback dispatch thread
+        void startDispatch();
+
+        /// Join the dispatch thread once it has drained; call after the producer stopped
+        void stopDispatch();
+
+        /// Producer: decode one packet and publish the pose
+        void publish(const uint8_t* packet, int length, int64_t hostTimeNs);
+
+        /// True while the callback ring is nearly full (a producer that must not drop can wait)
+        [[nodiscard]] bool backlogged() const;
+
+        [[nodiscard]] int frameCount() const { return frames.load(); }
+
+        /// Forget the frame count and first-packet time (new session)
+        void resetSession();
+
+        /// Host steady_clock ns of the first SLAM packet since resetSession() (0 until then)
+        [[nodiscard]] int64_t firstPacketHostNs() const { return firstPacketNs.load(); }
+
+        /// Block until the first SLAM packet of the session arrives or timeout passes
+        bool waitFirstPacket(std::chrono::milliseconds timeout);
+
+        /// The device is coming back with a restarted counter: rebase the next packet's
+        /// timestamp and wait for a new first packet, keeping the frame count
+        void expectDeviceRestart();
+        [[nodiscard]] const ClockSync& clock() const { return clockSync; }
+
+        /// Pose interpolated at host steady_clock hostTimeNs; lock-free, any thread (see PoseHistory::at)
+        [[nodiscard]] std::optional<Pose> sampleAt(int64_t hostTimeNs) const;
+        [[nodiscard]] uint64_t droppedPoses() const;
+
+        /// Counters the owner adds to (transport errors, recoveries)
+        StreamMetrics& metrics() { return streamMetrics; }
+
+        /// Stream counters plus ring drops; any thread, any time
+        void fillMetrics(SlamMetrics& out) const;
+
+    private:
+        void dispatchHandler();
+
+        std::shared_ptr<SubscriberTable> subscribers = std::make_shared<SubscriberTable>();
+        std::vector<packetTap> taps;
+        std::vector<std::shared_ptr<PoseRing>> rings;
+        std::vector<std::shared_ptr<ImuRing>> imuRings;
+        ImuCalibration imuCalibration;
+        std::atomic_bool conditionQuaternions{false};
+        std::array<int16_t, 4> lastQuaternion{};  // producer only
+        PoseFilter smoothing;
+        std::shared_ptr<PoseRing> callbackRing;
+        std::thread dispatchThread;
+        std::atomic_bool dispatching{false};
+        std::atomic<int> frames{0};
+        std::atomic<int64_t> firstPacketNs{0};
+        std::atomic_bool restartPending{false};
+        std::mutex firstPacketMutex;  // only taken for the first packet of a session
+        std::condition_variable firstPacket;
+        ClockSync clockSync;
+        PoseHistory history;
+        StreamMetrics streamMetrics;
+        PacketValidator validator{streamMetrics};  // after streamMetrics, which it counts into
+    };
+} // xv
+
+#endif // XVISIO_POSE_HUB_H
@@ -0,0 +1,81 @@
+/**
+ * @file pose_predictor.h
+ * @brief Host-side pose extrapolation to photon time
+ */
+
+#ifndef XVISIO_POSE_PREDICTOR_H
+#define XVISIO_POSE_PREDICTOR_H
+
+#include <cstdint>
+#include <optional>
+#include "pose.h"
+#include "raw_pose.h"
+#include "seq_ring.h"
+#include "subscription.h"
+
+namespace xv {
+
+class Slam;
+
+enum class PredictionModel : uint8_t {
+    Linear = 0,            ///< Constant velocity
+    ConstantAcceleration
+};
+
+struct PredictorOptions {
+    PredictionModel model = PredictionModel::Linear;
+    size_t window = 16;             ///< Samples per fit (~16 ms at 950 Hz), 3-63
+    double gyroScale = 0.0;         ///< rad/s per gyro LSB (bytes 43-48); 0 = derive from quaternions
+    int64_t maxHorizonUs = 50000;   ///< Never extrapolate further than this past the newest sample
+};
+
+/**
+ * Keeps a short pose history and extrapolates it to a requested device time.
+ *
+ * Position follows a least-squares fit over the last `window` samples, which
+ * averages away the 0.06 mm quantization that makes single-step differences
+ * useless at 1 kHz. Orientation is integrated forward from the angular velocity,
+ * taken from the gyro fields when their scale is known and otherwise from the
+ * rotation across the quaternion window.
+ *
+ * Fed by one thread (the Slam dispatch thread); predict() may be called from any thread.
+ */
+class PosePredictor {
+public:
+    using Model = PredictionModel;
+    using Options = PredictorOptions;
+
+    explicit PosePredictor(Options options = {});
+
+    /// Subscribe to a Slam stream (any time; unsubscribes when destroyed)
+    explicit PosePredictor(Slam& slam, Options options = {});
+
+    /// Add a sample (for feeding from a ring or replay instead of a Slam callback)
+    void update(const RawPose& raw);
+
+    /// Pose at targetTimeUs on the unwrapped device clock (RawPose::timeUs), or nothing before two samples.
+    /// For a host deadline pass slam.clock().hostToDevice(deadlineNs).
+    [[nodiscard]] std::optional<Pose> predict(int64_t targetTimeUs) const;
+
+    /// Pose leadUs after the newest sample
+    [[nodiscard]] std::optional<Pose> predictAhead(int64_t leadUs) const;
+
+    /// Unwrapped device time (µs) of the newest sample
+    [[nodiscard]] int64_t latestTimeUs() const;
+
+private:
+    struct Sample {
+        int64_t timeUs;
+        Vector3 position;
+        Vector4 orientation;
+        Vector3 angularVelocity;  // body frame, rad/s; zero when gyro is not used
+    };
+
+    Options options;
+    SeqRing<Sample, 64> history;
+    Subscription subscription;  // last: unsubscribed before history goes away
+};
+
+} // namespace xv
+
+#endif // XVISIO_POSE_PREDICTOR_H
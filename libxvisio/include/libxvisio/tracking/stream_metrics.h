@@ -0,0 +1,145 @@
+/**
+ * @file stream_metrics.h
+ * @brief Lock-free stream health counters and the snapshot Slam hands out
+ */
+
+#ifndef XVISIO_STREAM_METRICS_H
+#define XVISIO_STREAM_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xv {
+
+/// Why PacketValidator kept a packet from the subscribers (SlamMetrics::rejectedPackets index)
+enum class Rejection : uint8_t {
+    Length = 0,  ///< shorter than a SLAM packet
+    Header,      ///< not 01 A2 33 (HID reply, stray or garbled buffer)
+    Timestamp,   ///< did not move forward, or jumped too far
+    Motion,      ///< implied translation or rotation speed out of bounds
+};
+
+/// Callback dispatch cost of one subscriber
+struct SubscriberMetrics {
+    const char* kind = "";  ///< "raw", "pose" or "imu"
+    size_t index = 0;       ///< dispatch order (priority, then subscription) within its kind
+    uint64_t calls = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+
+    [[nodiscard]] double meanNs() const { return calls ? double(totalNs) / double(calls) : 0.0; }
+};
+
+/**
+ * Point-in-time view of a stream, copied out of relaxed atomics: every field is
+ * exact on its own, fields may be a packet apart from each other.
+ */
+struct SlamMetrics {
+    /// Upper bounds (µs) of the inter-arrival histogram buckets; the last bucket is open-ended
+    static constexpr std::array<int64_t, 11> INTERVAL_BOUNDS_US = {100, 250, 500, 750, 1000, 1250,
+                                                                   1500, 2000, 3000, 5000, 10000};
+
+    uint64_t packets = 0;
+    double packetRateHz = 0.0;  ///< over the last full second
+    std::array<uint64_t, INTERVAL_BOUNDS_US.size() + 1> interArrival{};  ///< host inter-arrival histogram
+    double jitterUs = 0.0;      ///< RFC 3550 interarrival jitter of transit time (host - device)
+
+    int64_t latencyNs = 0;      ///< edge-to-host transport latency of the newest packet (see ClockSync)
+    int64_t latencyMeanNs = 0;  ///< over the last full second
+    int64_t latencyMaxNs = 0;   ///< over the last full second
+
+    std::vector<SubscriberMetrics> subscribers;  ///< since the subscriber set last changed
+
+    std::array<uint64_t, 4> rejectedPackets{};  ///< indexed by Rejection
+    uint64_t substitutedPoses = 0;              ///< motion outliers replaced by a prediction
+
+    std::array<uint64_t, 7> transferErrors{};  ///< indexed by libusb_transfer_status
+    uint64_t recoveryAttempts = 0;
+    uint64_t recoveries = 0;
+    uint64_t reconnects = 0;
+
+    uint64_t droppedCallbackPoses = 0;  ///< callback dispatcher a full ring behind
+    uint64_t droppedRingPoses = 0;      ///< summed over rings from openPoseRing()
+    uint64_t droppedImuSamples = 0;     ///< summed over rings from openImuRing()
+};
+
+/**
+ * Writer side of SlamMetrics. Packet counters are written by the producer (USB or
+ * replay thread), subscriber timings by the dispatch thread, transport counters by
+ * the USB event thread; anyone may fill() a snapshot at any time.
+ */
+class StreamMetrics {
+public:
+    static constexpr size_t MAX_SUBSCRIBERS = 32;  // further subscribers are not timed
+
+    void reset();
+
+    /// Producer: one decoded packet
+    void packet(int64_t deviceTimeUs, int64_t hostTimeNs, int64_t latencyNs);
+
+    /// Dispatch thread: one callback invocation of subscriber slot
+    void subscriberCall(size_t slot, int64_t elapsedNs);
+
+    /// Dispatch thread: name the subscriber slots whenever the set changes; their timings restart
+    void describeSubscribers(size_t raw, size_t pose, size_t imu);
+
+    /// Producer: validation outcomes
+    void rejected(Rejection reason) { bump(rejections[size_t(reason)]); }
+    void substituted() { bump(substitutions); }
+
+    void transferError(int status);
+    void recoveryAttempt() { bump(recoveryAttempts); }
+    void recovered() { bump(recoveries); }
+
+    /// Everything above, into out (the drop and reconnect fields are left to the owner)
+    void fill(SlamMetrics& out) const;
+
+private:
+    using Counter = std::atomic<uint64_t>;
+
+    static void bump(Counter& counter, uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    struct alignas(64) Subscriber {
+        Counter calls{0};
+        Counter totalNs{0};
+        Counter maxNs{0};
+    };
+
+    // Producer
+    Counter packets{0};
+    std::array<Counter, SlamMetrics::INTERVAL_BOUNDS_US.size() + 1> histogram{};
+    std::atomic<double> packetRateHz{0.0};
+    std::atomic<double> jitterUs{0.0};
+    std::atomic<int64_t> latencyNs{0};
+    std::atomic<int64_t> latencyMeanNs{0};
+    std::atomic<int64_t> latencyMaxNs{0};
+    int64_t lastHostNs = -1;
+    int64_t lastTransitNs = 0;
+    double jitter = 0.0;
+    int64_t windowStartNs = 0;
+    uint64_t windowPackets = 0;
+    int64_t windowLatencySum = 0;
+    int64_t windowLatencyMax = 0;
+    std::array<Counter, 4> rejections{};
+    Counter substitutions{0};
+
+    // Dispatch thread
+    std::array<Subscriber, MAX_SUBSCRIBERS> subscribers{};
+    std::atomic<size_t> rawSubscribers{0};
+    std::atomic<size_t> poseSubscribers{0};
+    std::atomic<size_t> imuSubscribers{0};
+
+    // USB event thread
+    std::array<Counter, 7> transferErrors{};
+    Counter recoveryAttempts{0};
+    Counter recoveries{0};
+};
+
+} // namespace xv
+
+#endif // XVISIO_STREAM_METRICS_H
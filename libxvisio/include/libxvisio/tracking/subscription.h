@@ -0,0 +1,194 @@
+/**
+ * @file subscription.h
+ * @brief RAII subscriptions with priorities over an RCU-style subscriber snapshot
+ */
+
+#ifndef XVISIO_SUBSCRIPTION_H
+#define XVISIO_SUBSCRIPTION_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "fused_sample.h"
+#include "imu_sample.h"
+#include "pose.h"
+#include "raw_pose.h"
+
+namespace xv {
+
+class SubscriberTable;
+
+/// Owns one subscriber; unsubscribes when destroyed or reset. Outliving the stream is fine.
+class Subscription {
+public:
+    Subscription() = default;
+    Subscription(Subscription&& other) noexcept;
+    Subscription& operator=(Subscription&& other) noexcept;
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+    ~Subscription() { reset(); }
+
+    /// Unsubscribe now. Once this returns the subscriber is not running and will not be
+    /// called again, except when called from a callback (then it stops after the current pose).
+    void reset();
+
+    /// Keep the subscriber for the lifetime of the stream and forget the handle
+    void release() { table.reset(); }
+
+    explicit operator bool() const { return !table.expired(); }
+
+private:
+    friend class SubscriberTable;
+    Subscription(std::weak_ptr<SubscriberTable> table, uint64_t id) : table(std::move(table)), id(id) {}
+
+    std::weak_ptr<SubscriberTable> table;
+    uint64_t id = 0;
+};
+
+namespace detail {
+    /// Value type a subscriber function or method takes
+    template<typename F> struct SubscriberArg;
+    template<typename R, typename A> struct SubscriberArg<R (*)(A)> { using type = std::remove_cvref_t<A>; };
+    template<typename R, typename A> struct SubscriberArg<R (*)(A) noexcept> { using type = std::remove_cvref_t<A>; };
+    template<typename R, typename C, typename A> struct SubscriberArg<R (C::*)(A)> { using type = std::remove_cvref_t<A>; };
+    template<typename R, typename C, typename A> struct SubscriberArg<R (C::*)(A) const> { using type = std::remove_cvref_t<A>; };
+    template<typename R, typename C, typename A> struct SubscriberArg<R (C::*)(A) noexcept> { using type = std::remove_cvref_t<A>; };
+    template<typename R, typename C, typename A> struct SubscriberArg<R (C::*)(A) const noexcept> { using type = std::remove_cvref_t<A>; };
+
+    template<auto F>
+    using SubscriberArgOf = typename SubscriberArg<decltype(F)>::type;
+}
+
+/**
+ * One subscriber: a plain function pointer plus its object, called directly by the
+ * dispatch thread. The member and function forms allocate nothing; callable() keeps a
+ * copy of its callable on the heap (the std::function registration path).
+ */
+template<typename T>
+struct Subscriber {
+    void (*invoke)(void* object, const T& value) = nullptr;
+    void* object = nullptr;
+    int priority = 0;  ///< higher runs first; equal priorities run in subscription order
+    uint64_t id = 0;
+    std::shared_ptr<void> owned;
+
+    void operator()(const T& value) const { invoke(object, value); }
+
+    template<auto Method, typename C>
+    static Subscriber member(C& target, int priority = 0) {
+        return {&callMember<Method, C>, const_cast<void*>(static_cast<const void*>(&target)), priority, 0, nullptr};
+    }
+
+    template<auto Function>
+    static Subscriber function(int priority = 0) {
+        return {&callFunction<Function>, nullptr, priority, 0, nullptr};
+    }
+
+    template<typename F>
+    static Subscriber callable(F&& f, int priority = 0) {
+        using Held = std::decay_t<F>;
+        auto held = std::make_shared<Held>(std::forward<F>(f));
+        void* object = held.get();
+        return {&callHeld<Held>, object, priority, 0, std::move(held)};
+    }
+
+private:
+    template<auto Method, typename C>
+    static void callMember(void* object, const T& value) { std::invoke(Method, *static_cast<C*>(object), value); }
+
+    template<auto Function>
+    static void callFunction(void*, const T& value) { Function(value); }
+
+    template<typename F>
+    static void callHeld(void* object, const T& value) { (*static_cast<F*>(object))(value); }
+};
+
+/// Everything the dispatch thread calls, in call order within each kind
+struct SubscriberSnapshot {
+    std::vector<Subscriber<RawPose>> raw;
+    std::vector<Subscriber<Pose>> pose;
+    std::vector<Subscriber<ImuSample>> imu;
+    std::vector<Subscriber<FusedSample>> fused;  // PoseFusion's table only
+
+    template<typename T>
+    auto& of() {
+        if constexpr (std::is_same_v<T, RawPose>) return raw;
+        else if constexpr (std::is_same_v<T, Pose>) return pose;
+        else if constexpr (std::is_same_v<T, ImuSample>) return imu;
+        else {
+            static_assert(std::is_same_v<T, FusedSample>, "Subscribers take a RawPose, Pose, ImuSample or FusedSample");
+            return fused;
+        }
+    }
+};
+
+/**
+ * Copy-on-write subscriber set read by one dispatch thread.
+ *
+ * The reader brackets each pose with enter()/leave() and only touches the writer lock
+ * when the set changed. Writers copy the snapshot, publish it, and on removal wait
+ * for the reader to leave the old one, so a removed subscriber's object may be
+ * destroyed as soon as Subscription::reset() returns.
+ */
+class SubscriberTable : public std::enable_shared_from_this<SubscriberTable> {
+public:
+    SubscriberTable() : current(std::make_shared<const SubscriberSnapshot>()) {}
+
+    template<typename T>
+    Subscription add(Subscriber<T> subscriber) {
+        std::lock_guard lock(writer);
+        const uint64_t id = nextId++;
+        subscriber.id = id;
+        auto next = std::make_shared<SubscriberSnapshot>(*current);
+        auto& list = next->of<T>();
+        auto at = list.begin();
+        while (at != list.end() && at->priority >= subscriber.priority) ++at;
+        list.insert(at, std::move(subscriber));
+        count.fetch_add(1, std::memory_order_relaxed);
+        publish(std::move(next));
+        return {weak_from_this(), id};
+    }
+
+    void remove(uint64_t id);
+
+    /// Subscribers of every kind; lets the producer skip the dispatch ring when zero
+    [[nodiscard]] size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    // Reader side, all on the dispatch thread
+
+    /// Mark the calling thread as the reader (removals from it do not wait)
+    void bindReader() { readerThread.store(std::this_thread::get_id()); }
+
+    /// Current snapshot, valid until leave(); a different address than last time means the set changed
+    const SubscriberSnapshot& enter();
+    void leave() { reading.store(false); }
+
+private:
+    /// Under the writer lock
+    void publish(std::shared_ptr<const SubscriberSnapshot> next);
+
+    /// Block until the reader no longer uses a snapshot older than target
+    void waitForReader(uint64_t target) const;
+
+    std::mutex writer;
+    std::shared_ptr<const SubscriberSnapshot> current;
+    uint64_t nextId = 1;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> version{0};
+
+    // Written by the reader
+    std::atomic_bool reading{false};
+    std::atomic<uint64_t> readerVersion{0};
+    std::atomic<std::thread::id> readerThread{};
+    std::shared_ptr<const SubscriberSnapshot> held;
+    uint64_t heldVersion = 0;
+};
+
+} // namespace xv
+
+#endif // XVISIO_SUBSCRIPTION_H
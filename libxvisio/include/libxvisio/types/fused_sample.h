@@ -0,0 +1,49 @@
+/**
+ * @file fused_sample.h
+ * @brief Samples of external trackers (hands, controllers) before and after fusion with the XR50 pose
+ */
+
+#ifndef XVISIO_FUSED_SAMPLE_H
+#define XVISIO_FUSED_SAMPLE_H
+
+#include <array>
+#include <cstdint>
+
+namespace xv {
+
+/// Points per sample: palm plus four joints of five fingers, with room to spare
+inline constexpr uint32_t FUSION_MAX_POINTS = 24;
+
+using Point3f = std::array<float, 3>;
+
+/// What an external tracker saw, in its own frame and on its own clock
+struct ExternalSample {
+    int64_t sourceTimeUs = 0;  ///< Capture time on the tracker's clock (0: it has none, use hostTimeNs)
+    int64_t hostTimeNs = 0;    ///< Host steady_clock ns when the sample was received
+    uint16_t source = 0;       ///< PoseFusion::addSource() index
+    uint16_t kind = 0;         ///< Application-defined, e.g. left/right hand
+    uint32_t id = 0;           ///< Tracked object (hand id, controller index)
+    uint32_t pointCount = 0;
+    std::array<float, 4> orientation{1.0f, 0.0f, 0.0f, 0.0f};  ///< W, X, Y, Z (identity for hands)
+    std::array<Point3f, FUSION_MAX_POINTS> points{};          ///< Meters in the tracker's frame
+};
+
+/// An ExternalSample placed in the XR50 world frame, with the head pose at its capture time
+struct FusedSample {
+    int64_t deviceTimeUs = 0;  ///< Capture time on the XR50 clock (RawPose::timeUs)
+    int64_t hostTimeNs = 0;    ///< Capture time on host steady_clock
+    uint16_t source = 0;
+    uint16_t kind = 0;
+    uint32_t id = 0;
+    uint32_t pointCount = 0;
+    Point3f headPosition{};                                        ///< XR50 pose at deviceTimeUs, meters
+    std::array<float, 4> headOrientation{1.0f, 0.0f, 0.0f, 0.0f};  ///< W, X, Y, Z
+    std::array<float, 4> orientation{1.0f, 0.0f, 0.0f, 0.0f};      ///< World W, X, Y, Z
+    std::array<Point3f, FUSION_MAX_POINTS> points{};               ///< World, meters
+};
+
+static_assert(sizeof(FusedSample) == 360, "FusedSample is shared across processes");
+
+} // namespace xv
+
+#endif // XVISIO_FUSED_SAMPLE_H
@@ -0,0 +1,49 @@
+/**
+ * @file imu_sample.h
+ * @brief Inertial sample carried by every SLAM packet (bytes 37-48)
+ */
+
+#ifndef XVISIO_IMU_SAMPLE_H
+#define XVISIO_IMU_SAMPLE_H
+
+#include <cstdint>
+#include "pose.h"
+#include "raw_pose.h"
+
+namespace xv {
+
+inline constexpr double STANDARD_GRAVITY = 9.80665;
+
+/// Like xslam_imu, without the magnetometer (not in the packet)
+struct ImuSample {
+    Vector3 accel{};         ///< Accelerometer in m/s^2
+    Vector3 gyro{};          ///< Gyroscope in rad/s
+    int64_t timestamp = 0;   ///< Device µs, identical to the pose of the same packet (RawPose::timeUs)
+    int64_t hostTimeNs = 0;  ///< Host receive time of the packet
+};
+
+/**
+ * Raw-to-SI conversion. The scales follow the 2^-14 hypothesis in PROTOCOL.md
+ * (unconfirmed for moving devices); offsets are subtracted after scaling, as in xslam_imu_bias.
+ */
+struct ImuCalibration {
+    double accelScale = STANDARD_GRAVITY * FIXED_POINT_SCALE;  ///< m/s^2 per LSB
+    double gyroScale = FIXED_POINT_SCALE;                      ///< rad/s per LSB
+    Vector3 accelOffset{};                                     ///< m/s^2
+    Vector3 gyroOffset{};                                      ///< rad/s
+
+    [[nodiscard]] ImuSample apply(const RawPose& raw) const {
+        ImuSample sample;
+        for (size_t i = 0; i < 3; ++i) {
+            sample.accel[i] = raw.accel[i] * accelScale - accelOffset[i];
+            sample.gyro[i] = raw.gyro[i] * gyroScale - gyroOffset[i];
+        }
+        sample.timestamp = raw.timeUs;
+        sample.hostTimeNs = raw.hostTimeNs;
+        return sample;
+    }
+};
+
+} // namespace xv
+
+#endif // XVISIO_IMU_SAMPLE_H
@@ -15,6 +15,8 @@ using Vector3 = std::array<double, 3>;
 using Vector4 = std::array<double, 4>;
 
 struct Pose {
+    Pose() = default;
+
     /// Construct from rotation matrix (derives quaternion)
     Pose(const Vector3& pos, const Matrix3& rot, int64_t ts)
         : position(pos)
@@ -32,10 +34,10 @@ struct Pose {
     static Vector4 matrixToQuaternion(const Matrix3& matrix);
     static Matrix3 quaternionToMatrix(const Vector4& q);
 
-    Vector3 position;    ///< Position in meters (X, Y, Z)
-    Matrix3 matrix;      ///< Rotation matrix
-    Vector4 quaternion;  ///< Rotation quaternion (W, X, Y, Z)
-    int64_t timestamp;   ///< Timestamp in microseconds
+    Vector3 position{};    ///< Position in meters (X, Y, Z)
+    Matrix3 matrix{};      ///< Rotation matrix
+    Vector4 quaternion{};  ///< Rotation quaternion (W, X, Y, Z)
+    int64_t timestamp = 0; ///< Device time in microseconds (unwrapped, monotonic)
 };
 
 } // namespace xv
@@ -0,0 +1,56 @@
+/**
+ * @file pose_batch.h
+ * @brief Vectorized conversion of many packets or RawPoses into SoA float arrays
+ */
+
+#ifndef XVISIO_POSE_BATCH_H
+#define XVISIO_POSE_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include "raw_pose.h"
+
+namespace xv::batch {
+
+/// count records of stride bytes each, with the wire fields at fixed offsets inside a record
+struct Source {
+    const uint8_t* base = nullptr;
+    size_t stride = 0;
+    size_t count = 0;
+    uint32_t timestampOffset = 0;    ///< uint32 edge timestamp
+    uint32_t translationOffset = 0;  ///< 3 x int32, 2^-14 m
+    uint32_t quaternionOffset = 0;   ///< 4 x int16 W, X, Y, Z, 2^-14
+};
+
+/// Raw EP 0x83 packets (01 A2 33 ...), one every stride bytes (e.g. 80 for PacketRecording)
+inline Source packets(const uint8_t* first, size_t stride, size_t count) {
+    return {first, stride, count, 3, 7, 19};
+}
+
+/// Poses already decoded, e.g. drained from a PoseRing
+inline Source rawPoses(const RawPose* poses, size_t count) {
+    return {reinterpret_cast<const uint8_t*>(poses), sizeof(RawPose), count, offsetof(RawPose, timestamp),
+            offsetof(RawPose, translation), offsetof(RawPose, quaternion)};
+}
+
+/// Structure-of-arrays output, count elements each. timestamp and matrix may be null.
+struct PoseArrays {
+    uint32_t* timestamp = nullptr;
+    float* position[3] = {};    ///< X, Y, Z in meters
+    float* quaternion[4] = {};  ///< W, X, Y, Z
+    float* matrix[9] = {};      ///< row-major rotation matrix (all nine or none)
+};
+
+/// Convert with the widest kernel this CPU supports (AVX2, SSE2, NEON or scalar).
+/// Same results as RawPose::position()/orientation()/matrix(), in single precision.
+void convert(const Source& source, const PoseArrays& out);
+
+/// Portable reference kernel
+void convertScalar(const Source& source, const PoseArrays& out);
+
+/// Name of the kernel convert() dispatches to: "avx2", "sse2", "neon" or "scalar"
+const char* kernel();
+
+} // namespace xv::batch
+
+#endif // XVISIO_POSE_BATCH_H
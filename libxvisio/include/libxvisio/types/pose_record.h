@@ -0,0 +1,129 @@
+/**
+ * @file pose_record.h
+ * @brief Fixed-size binary pose and fused-sample records for full-rate streaming
+ *
+ * Stream layout (all integers and floats little-endian):
+ *
+ *   Preamble, once per stream (8 bytes)
+ *     0  char[4]  magic "XVPS"
+ *     4  uint16   version (1)
+ *     6  uint16   record size in bytes (36)
+ *
+ *   Record, repeated (36 bytes)
+ *     0  uint64   device time in µs (unwrapped edge timestamp, RawPose::timeUs)
+ *     8  float32  position X, Y, Z in meters
+ *    20  float32  quaternion W, X, Y, Z
+ *
+ * Fused-sample streams use the same preamble with magic "XVFS" and 352-byte records,
+ * one per tracked object (hand, controller) in the world frame:
+ *     0  uint64   device time in µs of the capture (FusedSample::deviceTimeUs)
+ *     8  uint16   source, 10 uint16 kind, 12 uint32 id
+ *    16  float32  head position X, Y, Z in meters at that time
+ *    28  float32  head quaternion W, X, Y, Z
+ *    44  float32  object orientation W, X, Y, Z
+ *    60  uint32   point count n (at most 24)
+ *    64  float32  24 points X, Y, Z in meters, the first n valid
+ *
+ * A reader checks the magic and skips unknown trailing record bytes when the
+ * record size grows in later versions.
+ */
+
+#ifndef XVISIO_POSE_RECORD_H
+#define XVISIO_POSE_RECORD_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include "fused_sample.h"
+#include "raw_pose.h"
+
+namespace xv::record {
+
+inline constexpr std::array<uint8_t, 4> MAGIC = {'X', 'V', 'P', 'S'};
+inline constexpr uint16_t VERSION = 1;
+inline constexpr size_t PREAMBLE_SIZE = 8;
+inline constexpr size_t RECORD_SIZE = 36;
+inline constexpr std::array<uint8_t, 4> FUSED_MAGIC = {'X', 'V', 'F', 'S'};
+inline constexpr size_t FUSED_RECORD_SIZE = 64 + 12 * FUSION_MAX_POINTS;
+
+using Preamble = std::array<uint8_t, PREAMBLE_SIZE>;
+using Record = std::array<uint8_t, RECORD_SIZE>;
+using FusedRecord = std::array<uint8_t, FUSED_RECORD_SIZE>;
+
+namespace detail {
+    inline void put16(uint8_t* out, uint16_t v) {
+        out[0] = uint8_t(v);
+        out[1] = uint8_t(v >> 8);
+    }
+
+    inline void put32(uint8_t* out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out[i] = uint8_t(v >> (8 * i));
+    }
+
+    inline void put64(uint8_t* out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out[i] = uint8_t(v >> (8 * i));
+    }
+
+    inline uint32_t get32(const uint8_t* in) {
+        return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+    }
+
+    inline void putFloats(uint8_t* out, const float* values, size_t count) {
+        for (size_t i = 0; i < count; ++i) put32(out + 4 * i, std::bit_cast<uint32_t>(values[i]));
+    }
+
+    inline Preamble preamble(const std::array<uint8_t, 4>& magic, size_t recordSize) {
+        Preamble out{};
+        std::copy(magic.begin(), magic.end(), out.begin());
+        put16(out.data() + 4, VERSION);
+        put16(out.data() + 6, uint16_t(recordSize));
+        return out;
+    }
+}
+
+inline Preamble preamble() { return detail::preamble(MAGIC, RECORD_SIZE); }
+
+inline Preamble fusedPreamble() { return detail::preamble(FUSED_MAGIC, FUSED_RECORD_SIZE); }
+
+inline Record encode(const RawPose& pose) {
+    Record out{};
+    detail::put64(out.data(), static_cast<uint64_t>(pose.timeUs));
+    const float values[7] = {
+        float(pose.translation[0] * FIXED_POINT_SCALE), float(pose.translation[1] * FIXED_POINT_SCALE),
+        float(pose.translation[2] * FIXED_POINT_SCALE), float(pose.quaternion[0] * FIXED_POINT_SCALE),
+        float(pose.quaternion[1] * FIXED_POINT_SCALE), float(pose.quaternion[2] * FIXED_POINT_SCALE),
+        float(pose.quaternion[3] * FIXED_POINT_SCALE)};
+    detail::putFloats(out.data() + 8, values, 7);
+    return out;
+}
+
+inline FusedRecord encode(const FusedSample& sample) {
+    FusedRecord out{};
+    detail::put64(out.data(), static_cast<uint64_t>(sample.deviceTimeUs));
+    detail::put16(out.data() + 8, sample.source);
+    detail::put16(out.data() + 10, sample.kind);
+    detail::put32(out.data() + 12, sample.id);
+    detail::putFloats(out.data() + 16, sample.headPosition.data(), 3);
+    detail::putFloats(out.data() + 28, sample.headOrientation.data(), 4);
+    detail::putFloats(out.data() + 44, sample.orientation.data(), 4);
+    const uint32_t count = std::min(sample.pointCount, FUSION_MAX_POINTS);
+    detail::put32(out.data() + 60, count);
+    for (uint32_t i = 0; i < count; ++i) detail::putFloats(out.data() + 64 + 12 * i, sample.points[i].data(), 3);
+    return out;
+}
+
+/// Read one record back (the inverse of encode())
+inline Pose decode(const uint8_t* in) {
+    uint64_t time = 0;
+    for (int i = 7; i >= 0; --i) time = time << 8 | in[i];
+    float values[7];
+    for (int i = 0; i < 7; ++i) values[i] = std::bit_cast<float>(detail::get32(in + 8 + 4 * i));
+    return Pose{Vector3{values[0], values[1], values[2]}, Vector4{values[3], values[4], values[5], values[6]},
+                static_cast<int64_t>(time)};
+}
+
+} // namespace xv::record
+
+#endif // XVISIO_POSE_RECORD_H
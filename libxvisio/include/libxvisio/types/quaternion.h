@@ -0,0 +1,79 @@
+/**
+ * @file quaternion.h
+ * @brief Quaternion helpers on Vector4 (W, X, Y, Z)
+ */
+
+#ifndef XVISIO_QUATERNION_H
+#define XVISIO_QUATERNION_H
+
+#include <cmath>
+#include "pose.h"
+
+namespace xv::quat {
+
+inline Vector4 multiply(const Vector4& a, const Vector4& b) {
+    return {a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+            a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+            a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+            a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0]};
+}
+
+inline Vector4 conjugate(const Vector4& q) { return {q[0], -q[1], -q[2], -q[3]}; }
+
+inline double dot(const Vector4& a, const Vector4& b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+}
+
+inline Vector4 normalize(const Vector4& q) {
+    const double norm = std::sqrt(dot(q, q));
+    if (norm == 0.0) return {1.0, 0.0, 0.0, 0.0};
+    return {q[0] / norm, q[1] / norm, q[2] / norm, q[3] / norm};
+}
+
+/// q or -q, whichever lies in the same hemisphere as reference
+inline Vector4 alignHemisphere(const Vector4& q, const Vector4& reference) {
+    return dot(q, reference) < 0.0 ? Vector4{-q[0], -q[1], -q[2], -q[3]} : q;
+}
+
+/// Rotation by angular velocity omega (rad/s) held for dt seconds
+inline Vector4 fromAngularVelocity(const Vector3& omega, double dt) {
+    const double rate = std::sqrt(omega[0] * omega[0] + omega[1] * omega[1] + omega[2] * omega[2]);
+    const double half = 0.5 * rate * dt;
+    if (rate < 1e-12) return {1.0, 0.5 * omega[0] * dt, 0.5 * omega[1] * dt, 0.5 * omega[2] * dt};
+    const double s = std::sin(half) / rate;
+    return {std::cos(half), omega[0] * s, omega[1] * s, omega[2] * s};
+}
+
+/// Angular velocity (rad/s) that turns a unit rotation delta within dt seconds
+inline Vector3 toAngularVelocity(const Vector4& delta, double dt) {
+    const Vector4 d = delta[0] < 0.0 ? Vector4{-delta[0], -delta[1], -delta[2], -delta[3]} : delta;
+    const double sinHalf = std::sqrt(d[1] * d[1] + d[2] * d[2] + d[3] * d[3]);
+    const double angle = 2.0 * std::atan2(sinHalf, d[0]);
+    const double scale = sinHalf < 1e-12 ? 2.0 / dt : angle / (sinHalf * dt);
+    return {d[1] * scale, d[2] * scale, d[3] * scale};
+}
+
+/// Shortest-path spherical interpolation, t in [0, 1]
+inline Vector4 slerp(const Vector4& a, const Vector4& b, double t) {
+    const Vector4 c = alignHemisphere(b, a);
+    const double cosTheta = dot(a, c);
+    if (cosTheta > 0.9995) {
+        // Nearly parallel: normalized lerp is accurate and avoids dividing by ~0
+        return normalize({a[0] + t * (c[0] - a[0]), a[1] + t * (c[1] - a[1]),
+                          a[2] + t * (c[2] - a[2]), a[3] + t * (c[3] - a[3])});
+    }
+    const double theta = std::acos(cosTheta);
+    const double wa = std::sin((1.0 - t) * theta) / std::sin(theta);
+    const double wb = std::sin(t * theta) / std::sin(theta);
+    return {wa * a[0] + wb * c[0], wa * a[1] + wb * c[1], wa * a[2] + wb * c[2], wa * a[3] + wb * c[3]};
+}
+
+/// Rotate vector v by unit quaternion q
+inline Vector3 rotate(const Vector4& q, const Vector3& v) {
+    const Vector4 r = multiply(multiply(q, {0.0, v[0], v[1], v[2]}), conjugate(q));
+    return {r[1], r[2], r[3]};
+}
+
+} // namespace xv::quat
+
+#endif // XVISIO_QUATERNION_H
@@ -0,0 +1,84 @@
+/**
+ * @file raw_pose.h
+ * @brief Compact fixed-point pose, exactly as carried by a SLAM packet
+ */
+
+#ifndef XVISIO_RAW_POSE_H
+#define XVISIO_RAW_POSE_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "pose.h"
+
+namespace xv {
+
+/// Fixed-point scale of every translation/rotation field: 2^-14
+inline constexpr double FIXED_POINT_SCALE = 6.103515625e-05;
+
+/// Bytes of a SLAM packet up to its last decoded field (confidence, bytes 57-58)
+inline constexpr int SLAM_PACKET_LENGTH = 59;
+
+/**
+ * Wire-decoded pose (56 bytes, trivially copyable).
+ *
+ * Fields keep the device's integer encoding (see PROTOCOL.md, "SLAM Packet Format");
+ * floating-point values are derived on demand by the accessors. Slam adds the
+ * unwrapped device time and the host receive time.
+ */
+struct RawPose {
+    uint32_t timestamp = 0;                  ///< Edge timestamp in microseconds (bytes 3-6)
+    std::array<int32_t, 3> translation{};    ///< X, Y, Z in 2^-14 m (bytes 7-18)
+    std::array<int16_t, 4> quaternion{};     ///< W, X, Y, Z in 2^-14 (bytes 19-26)
+    std::array<int16_t, 3> accel{};          ///< Accelerometer X, Y, Z, hypothesised (bytes 37-42)
+    std::array<int16_t, 3> gyro{};           ///< Gyroscope X, Y, Z, hypothesised (bytes 43-48)
+    int16_t confidence = 0;                  ///< Confidence/status, hypothesised (bytes 57-58)
+    int64_t timeUs = 0;                      ///< Edge timestamp unwrapped to a monotonic 64-bit count
+    int64_t hostTimeNs = 0;                  ///< Host steady_clock at USB completion (0 if not received live)
+
+    /// True for a full SLAM packet (01 A2 33 header), as opposed to a HID reply or stray buffer
+    static bool isSlamPacket(const uint8_t* packet, int length) {
+        return length >= SLAM_PACKET_LENGTH && packet[0] == 0x01 && packet[1] == 0xa2 && packet[2] == 0x33;
+    }
+
+    /// Copy the fields out of a 63-byte packet (little-endian host)
+    static RawPose decode(const uint8_t* packet) {
+        RawPose raw;
+        std::memcpy(&raw.timestamp, packet + 3, sizeof(raw.timestamp));
+        std::memcpy(raw.translation.data(), packet + 7, sizeof(raw.translation));
+        std::memcpy(raw.quaternion.data(), packet + 19, sizeof(raw.quaternion));
+        std::memcpy(raw.accel.data(), packet + 37, sizeof(raw.accel));
+        std::memcpy(raw.gyro.data(), packet + 43, sizeof(raw.gyro));
+        std::memcpy(&raw.confidence, packet + 57, sizeof(raw.confidence));
+        raw.timeUs = raw.timestamp;
+        return raw;
+    }
+
+    /// Rescale the quaternion to unit length (to the nearest 2^-14 step) and flip its sign
+    /// into the hemisphere of reference, so consecutive poses are continuous. Branch-free
+    /// apart from leaving an all-zero quaternion alone; returns the result for the next call.
+    std::array<int16_t, 4> conditionQuaternion(const std::array<int16_t, 4>& reference) {
+        int64_t norm = 0, dot = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            norm += int32_t(quaternion[i]) * quaternion[i];
+            dot += int32_t(quaternion[i]) * reference[i];
+        }
+        if (norm == 0) return reference;
+        const double scale = std::copysign(16384.0, double(dot)) / std::sqrt(double(norm));
+        for (auto& q : quaternion) q = int16_t(std::lrint(q * scale));
+        return quaternion;
+    }
+
+    [[nodiscard]] Vector3 position() const;      ///< Meters
+    [[nodiscard]] Vector4 orientation() const;   ///< Quaternion (W, X, Y, Z)
+    [[nodiscard]] Matrix3 matrix() const;        ///< Rotation matrix
+    [[nodiscard]] Vector3 eulerDegrees() const;  ///< Roll, pitch, yaw in degrees
+    [[nodiscard]] Pose toPose() const;
+};
+
+static_assert(sizeof(RawPose) == 56, "RawPose must stay compact");
+
+} // namespace xv
+
+#endif // XVISIO_RAW_POSE_H
@@ -0,0 +1,159 @@
+/**
+ * @file logging.h
+ * @brief Compile-time filtered logging, formatted off-thread
+ *
+ * Call sites only capture their arguments into a fixed-size record and push it
+ * onto a lock-free queue; a background sink thread does all formatting and I/O.
+ * Levels below XV_LOG_LEVEL compile to nothing, arguments included.
+ *
+ *     XV_WARN("Transfer {} after {} frames", statusName, frames);
+ *     XV_TRACE("Raw: {}", xv::log::Hex{buffer, 63});
+ */
+
+#ifndef XVISIO_LOGGING_H
+#define XVISIO_LOGGING_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/// 0 = trace, 1 = debug, 2 = info, 3 = warn, 4 = error, 5 = off
+#ifndef XV_LOG_LEVEL
+#  ifdef NDEBUG
+#    define XV_LOG_LEVEL 2
+#  else
+#    define XV_LOG_LEVEL 0
+#  endif
+#endif
+
+namespace xv::log {
+
+enum class Level : uint8_t { Trace = 0, Debug, Info, Warn, Error, Off };
+
+inline constexpr Level COMPILED_LEVEL = static_cast<Level>(XV_LOG_LEVEL);
+
+constexpr bool enabled(Level level) { return level >= COMPILED_LEVEL && level != Level::Off; }
+
+/// Byte range rendered as space-separated hex
+struct Hex {
+    const uint8_t* data;
+    size_t length;
+};
+
+/// Byte range rendered as little-endian int16 values
+struct Int16s {
+    const uint8_t* data;
+    size_t count;
+};
+
+/// Captured call site: format string plus raw argument values
+struct Record {
+    static constexpr size_t MAX_ARGS = 8;
+    static constexpr size_t STORAGE = 160;
+
+    enum class Kind : uint8_t { Int, UInt, Double, Text, Hex, Int16s };
+
+    struct Arg {
+        Kind kind;
+        uint8_t offset;  // Text/Hex/Int16s: position in storage
+        uint8_t length;  // Text/Hex: bytes, Int16s: values
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+        };
+    };
+
+    Level level = Level::Info;
+    uint8_t argCount = 0;
+    uint8_t used = 0;
+    const char* format = "";  // must be a string literal
+    std::array<Arg, MAX_ARGS> args{};
+    std::array<uint8_t, STORAGE> storage{};
+
+    void add(Kind kind, const void* data, size_t bytes) {
+        if (argCount == MAX_ARGS) return;
+        bytes = std::min(bytes, STORAGE - used);
+        Arg& arg = args[argCount++];
+        arg.kind = kind;
+        arg.offset = used;
+        arg.length = static_cast<uint8_t>(kind == Kind::Int16s ? bytes / 2 : bytes);
+        std::memcpy(storage.data() + used, data, bytes);
+        used += static_cast<uint8_t>(bytes);
+    }
+
+    template<typename T>
+    void add(const T& value) {
+        if constexpr (std::is_same_v<T, Hex>) {
+            add(Kind::Hex, value.data, value.length);
+        } else if constexpr (std::is_same_v<T, Int16s>) {
+            add(Kind::Int16s, value.data, value.count * 2);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            const std::string_view text = value;
+            add(Kind::Text, text.data(), text.size());
+        } else if (argCount < MAX_ARGS) {
+            Arg& arg = args[argCount++];
+            if constexpr (std::is_floating_point_v<T>) {
+                arg.kind = Kind::Double;
+                arg.d = value;
+            } else if constexpr (std::is_enum_v<T>) {
+                arg.kind = Kind::Int;
+                arg.i = static_cast<int64_t>(value);
+            } else if constexpr (std::is_signed_v<T>) {
+                arg.kind = Kind::Int;
+                arg.i = value;
+            } else {
+                arg.kind = Kind::UInt;
+                arg.u = value;
+            }
+        }
+    }
+};
+
+using Sink = std::function<void(Level level, std::string_view message)>;
+
+/// Queue a record for the sink thread. Never blocks; drops (and counts) when the queue is full.
+void submit(const Record& record);
+
+/// Replace the output (default: "[XR50] message" lines on stderr). Called from the sink thread.
+void setSink(Sink sink);
+
+/// Runtime threshold on top of the compile-time one
+void setLevel(Level level);
+[[nodiscard]] Level level();
+
+/// Block until every record queued so far has reached the sink
+void flush();
+
+/// Records lost to a full queue
+[[nodiscard]] uint64_t dropped();
+
+/// Render a record the way the sink thread does
+[[nodiscard]] std::string format(const Record& record);
+
+template<typename... Args>
+void post(Level lvl, const char* fmt, const Args&... args) {
+    if (lvl < level()) return;
+    Record record;
+    record.level = lvl;
+    record.format = fmt;
+    (record.add(args), ...);
+    submit(record);
+}
+
+} // namespace xv::log
+
+#define XV_LOG(level, ...) \
+    do { if constexpr (::xv::log::enabled(level)) ::xv::log::post(level, __VA_ARGS__); } while (false)
+#define XV_TRACE(...) XV_LOG(::xv::log::Level::Trace, __VA_ARGS__)
+#define XV_DEBUG(...) XV_LOG(::xv::log::Level::Debug, __VA_ARGS__)
+#define XV_INFO(...) XV_LOG(::xv::log::Level::Info, __VA_ARGS__)
+#define XV_WARN(...) XV_LOG(::xv::log::Level::Warn, __VA_ARGS__)
+#define XV_ERROR(...) XV_LOG(::xv::log::Level::Error, __VA_ARGS__)
+
+#endif // XVISIO_LOGGING_H
@@ -0,0 +1,49 @@
+/**
+ * @file run_flag.h
+ * @brief Atomic running flag that other threads can block on until it clears
+ */
+
+#ifndef XVISIO_RUN_FLAG_H
+#define XVISIO_RUN_FLAG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace xv {
+
+/**
+ * isSet() is a plain atomic load, cheap enough for the USB thread; waitCleared()
+ * parks the caller on a condition variable instead of polling isSet().
+ */
+class RunFlag {
+public:
+    void set() { flag.store(true); }
+
+    void clear() {
+        {
+            std::lock_guard lock(mutex);
+            flag.store(false);
+        }
+        cleared.notify_all();
+    }
+
+    [[nodiscard]] bool isSet() const { return flag.load(); }
+
+    /// Block until the flag is clear or timeout passes. Returns true when clear.
+    template<typename Rep, typename Period>
+    bool waitCleared(std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock lock(mutex);
+        return cleared.wait_for(lock, timeout, [this] { return !flag.load(); });
+    }
+
+private:
+    std::atomic_bool flag{false};
+    std::mutex mutex;
+    std::condition_variable cleared;
+};
+
+} // namespace xv
+
+#endif // XVISIO_RUN_FLAG_H
@@ -0,0 +1,94 @@
+/**
+ * @file seq_ring.h
+ * @brief Single-writer history ring readable by any number of lock-free readers
+ */
+
+#ifndef XVISIO_SEQ_RING_H
+#define XVISIO_SEQ_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace xv {
+
+/**
+ * Keeps the last Capacity items; readers never block the writer and never lock.
+ *
+ * Every slot is a seqlock whose payload is stored as relaxed atomic words, so
+ * a torn read is detected rather than being a data race. The layout holds no
+ * pointers and is usable in memory shared between processes.
+ */
+template<typename T, size_t Capacity>
+class SeqRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqRing items are copied bytewise");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /// Writer: publish an item, overwriting the oldest
+    void push(const T& item) {
+        const uint64_t index = head.load(std::memory_order_relaxed);
+        Slot& slot = slots[index & MASK];
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &item, sizeof(T));
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) slot.words[i].store(words[i], std::memory_order_relaxed);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    /// Items ever pushed; the newest has index count() - 1
+    [[nodiscard]] uint64_t count() const { return head.load(std::memory_order_acquire); }
+
+    /// Read item `index`; false if it was not written yet or has been overwritten
+    bool read(uint64_t index, T& out) const {
+        const Slot& slot = slots[index & MASK];
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) return false;
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) words[i] = slot.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) return false;
+        std::memcpy(&out, words, sizeof(T));
+        return true;
+    }
+
+    bool latest(T& out) const {
+        const uint64_t n = count();
+        return n > 0 && read(n - 1, out);
+    }
+
+    /// Copy up to max of the most recent items into out, oldest first. Returns how many.
+    size_t readRecent(T* out, size_t max) const {
+        const uint64_t n = count();
+        const size_t want = static_cast<size_t>(std::min<uint64_t>({max, n, Capacity - 1}));
+        size_t got = 0;
+        // Newest first, stopping at the first slot the writer has lapped
+        while (got < want && read(n - 1 - got, out[want - 1 - got])) ++got;
+        if (got < want) std::move(out + want - got, out + want, out);
+        return got;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr uint64_t MASK = Capacity - 1;
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // 2i+1 while item i is written, 2i+2 once complete
+        std::atomic<uint64_t> words[WORDS] = {};
+    };
+
+    std::atomic<uint64_t> head{0};
+    Slot slots[Capacity];
+};
+
+} // namespace xv
+
+#endif // XVISIO_SEQ_RING_H
@@ -0,0 +1,136 @@
+/**
+ * @file spsc_ring.h
+ * @brief Fixed-size lock-free single-producer/single-consumer ring
+ */
+
+#ifndef XVISIO_SPSC_RING_H
+#define XVISIO_SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace xv {
+
+inline constexpr size_t CACHE_LINE = 64;
+
+/**
+ * Bounded ring with one producer thread and one consumer thread.
+ *
+ * The producer never blocks: when the ring is full the new item is dropped and
+ * counted. Producer and consumer indices live on separate cache lines; the
+ * condition variable is only touched when a consumer is parked in waitFor().
+ */
+template<typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /// Producer: enqueue a copy of item. Returns false (and counts a drop) when full.
+    bool tryPush(const T& item) {
+        const uint64_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedReadIndex >= Capacity) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if (head - cachedReadIndex >= Capacity) {
+                dropCount.store(dropCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (!full) overrunCount.store(overrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                full = true;
+                return false;
+            }
+        }
+        full = false;
+        slots[head & MASK] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+
+        // Pairs with the waiter registration in waitFor(): either it sees the new index or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard lock(waitMutex);
+            wakeup.notify_one();
+        }
+        return true;
+    }
+
+    /// Consumer: dequeue the oldest item.
+    bool tryPop(T& out) {
+        const uint64_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == cachedWriteIndex) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            if (tail == cachedWriteIndex) return false;
+        }
+        out = slots[tail & MASK];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: take the newest item and discard everything older.
+    bool popLatest(T& out) {
+        const uint64_t tail = readIndex.load(std::memory_order_relaxed);
+        const uint64_t head = cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+        if (tail == head) return false;
+        out = slots[(head - 1) & MASK];
+        skipCount.store(skipCount.load(std::memory_order_relaxed) + (head - 1 - tail), std::memory_order_relaxed);
+        readIndex.store(head, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: pop the oldest item, sleeping up to timeout for one to arrive.
+    template<typename Rep, typename Period>
+    bool waitFor(T& out, std::chrono::duration<Rep, Period> timeout) {
+        if (tryPop(out)) return true;
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(waitMutex);
+            wakeup.wait_for(lock, timeout, [this] { return !empty(); });
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return tryPop(out);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    /// Items rejected because the consumer fell a full ring behind
+    [[nodiscard]] uint64_t drops() const { return dropCount.load(std::memory_order_relaxed); }
+    /// Distinct episodes of the ring filling up (each may drop many items)
+    [[nodiscard]] uint64_t overruns() const { return overrunCount.load(std::memory_order_relaxed); }
+    /// Items the consumer discarded through popLatest()
+    [[nodiscard]] uint64_t skipped() const { return skipCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t MASK = Capacity - 1;
+
+    // Producer-owned line
+    alignas(CACHE_LINE) std::atomic<uint64_t> writeIndex{0};
+    uint64_t cachedReadIndex = 0;
+    bool full = false;
+    std::atomic<uint64_t> dropCount{0};
+    std::atomic<uint64_t> overrunCount{0};
+
+    // Consumer-owned line
+    alignas(CACHE_LINE) std::atomic<uint64_t> readIndex{0};
+    uint64_t cachedWriteIndex = 0;
+    std::atomic<uint64_t> skipCount{0};
+
+    // Slow path for blocking consumers
+    alignas(CACHE_LINE) std::atomic<int> waiters{0};
+    std::mutex waitMutex;
+    std::condition_variable wakeup;
+
+    alignas(CACHE_LINE) std::array<T, Capacity> slots{};
+};
+
+} // namespace xv
+
+#endif // XVISIO_SPSC_RING_H
@@ -0,0 +1,34 @@
+/**
+ * @file thread_policy.h
+ * @brief Real-time scheduling, CPU pinning and memory locking for latency-critical threads
+ */
+
+#ifndef XVISIO_THREAD_POLICY_H
+#define XVISIO_THREAD_POLICY_H
+
+#include <vector>
+
+namespace xv {
+
+/**
+ * How a thread should be scheduled. The defaults change nothing.
+ *
+ * Per platform:
+ *   Linux    SCHED_FIFO at realtimePriority, pthread affinity, mlockall(MCL_CURRENT | MCL_FUTURE)
+ *   macOS    QoS user-interactive plus a 1 ms time-constraint policy; no pinning or memory locking
+ *   Windows  MMCSS "Pro Audio" task at critical priority, SetThreadAffinityMask; no memory locking
+ */
+struct ThreadPolicy {
+    int realtimePriority = 0;  ///< 1-99 for SCHED_FIFO (clamped); 0 keeps the default scheduler
+    std::vector<int> cpus;     ///< Run only on these CPUs; empty = any
+    bool lockMemory = false;   ///< Keep the whole process (rings included) resident, now and later
+};
+
+/// Apply policy to the calling thread, in the order affinity, scheduling, memory.
+/// Throws std::runtime_error at the first step that fails, naming the privilege it needs;
+/// steps a platform lacks are skipped with a warning.
+void applyThreadPolicy(const ThreadPolicy& policy);
+
+} // namespace xv
+
+#endif // XVISIO_THREAD_POLICY_H
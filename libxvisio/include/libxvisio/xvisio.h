@@ -5,36 +5,74 @@
 #ifndef LIBXVISIO_XVISIO_H
 #define LIBXVISIO_XVISIO_H
 
+#include <chrono>
+#include <condition_variable>
+#include <string>
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <libusb.h>
 #include "device.h"
+#include "event_loop.h"
 #include "slam.h"
 
 namespace xv {
+    /// Where construction of an XVisio spent its time
+    struct EnumerationTiming {
+        struct Entry {
+            std::string uuid;                       ///< empty when opening failed
+            std::string error;                      ///< why opening failed
+            std::chrono::microseconds open{0};      ///< libusb_open and interface claim
+            std::chrono::microseconds identify{0};  ///< UUID, version and features round trips
+            std::chrono::microseconds total{0};     ///< from the start of enumeration until this device was ready
+        };
+
+        std::chrono::microseconds listing{0};  ///< libusb_get_device_list and descriptor filtering
+        std::chrono::microseconds total{0};    ///< whole enumeration, devices opened concurrently
+        std::vector<Entry> devices;            ///< in enumeration order
+    };
+
     class XVisio {
     public:
         XVisio();
 
+        /// Open every connected XR50 concurrently (up to 8 at a time).
+        /// @param timeout HID timeout in ms of each identification command
         explicit XVisio(uint32_t timeout);
 
         ~XVisio();
 
         const std::vector<std::shared_ptr<Device>>& getDevices();
 
+        [[nodiscard]] const EnumerationTiming& getEnumerationTiming() const { return enumerationTiming; }
+
         /// Process devices discovered via hotplug. Call from main thread periodically.
+        /// A returning device whose Slam waits for it (Slam::setAutoReconnect) is rebound
+        /// automatically and does not show up here again.
         void pollNewDevices();
 
     private:
         libusb_context* usb_ctx = nullptr;
+        std::unique_ptr<EventLoop> eventLoop;  // the only thread handling usb_ctx events
         std::vector<std::shared_ptr<Device>> devices;
+        EnumerationTiming enumerationTiming;
+
+        void enumerate(uint32_t timeout);
 
-        // Hotplug queues raw device pointers; Device construction happens outside the callback
+        // Hotplug queues raw device pointers; the arrival thread matches them against
+        // disconnected Devices and passes the rest on to pollNewDevices()
         std::mutex pendingMutex;
+        std::condition_variable pendingChanged;
         std::vector<libusb_device*> pendingDevices;
+        std::vector<libusb_device*> newDevices;
+        bool stopping = false;
+        std::thread arrivalThread;
+        std::mutex devicesMutex;  // devices is appended by pollNewDevices() while arrivals read it
         libusb_hotplug_callback_handle hotplugHandle = 0;
 
+        void handleArrivals();
+
         static int LIBUSB_CALL
         hotPlugCallback(libusb_context* ctx, libusb_device* device,
                         libusb_hotplug_event event, void* user_data);
@@ -0,0 +1,119 @@
+/**
+ * @file xvisio_c.h
+ * @brief C API of libxvisio, for ctypes, P/Invoke and other FFIs
+ *
+ * The same functions and structs as xvisio-rs's include/xvisio.h, so a consumer
+ * of that header can link libxvisio instead, plus xv_slam_recv_many() to drain
+ * every queued pose in one call. Plain C, fixed layouts, no callbacks: poses
+ * queue in a ring on the USB thread and the caller pulls them when it likes.
+ *
+ * Differences from xvisio-rs: timestamp_us is the unwrapped device time (it does
+ * not wrap after 71 minutes), host_timestamp_s is steady_clock, and the error
+ * string is per thread.
+ */
+
+#ifndef XVISIO_C_H
+#define XVISIO_C_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(XVISIO_C_EXPORTS)
+#define XV_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define XV_API __declspec(dllimport)
+#else
+#define XV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Opaque device handle */
+typedef struct XvDevice XvDevice;
+
+/** Opaque SLAM stream handle */
+typedef struct XvSlamStream XvSlamStream;
+
+/** One connected XR50 (229 bytes of fields, padded to 232) */
+typedef struct XvDeviceInfo {
+    char uuid[64];      /**< Null-terminated UUID */
+    char version[128];  /**< Null-terminated firmware version */
+    uint32_t features;  /**< Feature bitmap */
+    char bus_id[32];    /**< Null-terminated USB location, "bus-port.port" */
+    uint8_t address;    /**< USB device address */
+} XvDeviceInfo;
+
+/** One pose (176 bytes, all 8-byte fields) */
+typedef struct XvPose {
+    double translation[3];   /**< X, Y, Z in meters */
+    double rotation[9];      /**< Rotation matrix, row-major */
+    double quaternion[4];    /**< qx, qy, qz, qw */
+    uint64_t timestamp_us;   /**< Device time in microseconds */
+    double host_timestamp_s; /**< Host steady clock at USB completion, in seconds */
+    double confidence;       /**< Tracking confidence in [0, 1] */
+    double euler_deg[3];     /**< Roll, pitch, yaw in degrees (Three.js YXZ, Z flipped) */
+} XvPose;
+
+/**
+ * List connected XR50s: writes up to max entries into out (may be NULL) and
+ * returns the number of entries, at most max, or -1 on error.
+ */
+XV_API int xv_list_devices(XvDeviceInfo* out, int max);
+
+/** Open the first XR50. Returns NULL on error (see xv_last_error()). */
+XV_API XvDevice* xv_open_first(void);
+
+/** Open the XR50 with info's UUID, or at info's bus_id if the UUID is empty. Returns NULL on error. */
+XV_API XvDevice* xv_open_device(const XvDeviceInfo* info);
+
+/** Close a device handle. A stream started on it keeps the device open until xv_stop_slam(). NULL is ignored. */
+XV_API void xv_close_device(XvDevice* dev);
+
+/** Device UUID, valid while the device is open; NULL for a NULL device */
+XV_API const char* xv_device_uuid(const XvDevice* dev);
+
+/** Firmware version, valid while the device is open; NULL for a NULL device */
+XV_API const char* xv_device_version(const XvDevice* dev);
+
+/** Feature bitmap; 0 for a NULL device */
+XV_API uint32_t xv_device_features(const XvDevice* dev);
+
+/**
+ * Start SLAM: mode 0 = Edge, 1 = Mixed. Returns once the first pose arrived (or
+ * after a few seconds without one), NULL on error. One stream per device at a time;
+ * it survives unplugging and resumes when the device comes back.
+ */
+XV_API XvSlamStream* xv_start_slam(XvDevice* dev, int mode);
+
+/**
+ * Take the oldest queued pose, waiting up to timeout_ms (0 = do not wait,
+ * -1 = until a pose arrives or the stream ends). Returns 0 on success, -1 on
+ * timeout or error. Up to 1024 poses queue; while the queue is full new ones are dropped.
+ * Receive calls on one stream must not run concurrently.
+ */
+XV_API int xv_slam_recv(XvSlamStream* stream, XvPose* pose, int timeout_ms);
+
+/**
+ * Take up to max queued poses, oldest first, without waiting. Returns the count
+ * written to out (0 if none is queued), or -1 on error. Call once per frame, or
+ * after a successful xv_slam_recv() with a timeout, to consume the stream at full
+ * rate with one FFI crossing per batch.
+ */
+XV_API int xv_slam_recv_many(XvSlamStream* stream, XvPose* out, int max);
+
+/** False once the stream stopped on its own (e.g. an unrecoverable USB error), or for NULL */
+XV_API bool xv_slam_is_active(const XvSlamStream* stream);
+
+/** Stop a stream and free it. NULL is ignored. */
+XV_API void xv_stop_slam(XvSlamStream* stream);
+
+/** This thread's last error message, NULL if none; valid until this thread's next failing call */
+XV_API const char* xv_last_error(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // XVISIO_C_H
@@ -0,0 +1,289 @@
+/**
+ * @file leap.cpp
+ * @brief Minimal JSON reading of v6 frames, and the tracking service's WebSocket handshake and frames
+ */
+
+#include "leap.h"
+#include "websocket.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <utility>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace leap {
+
+namespace {
+    constexpr size_t MAX_MESSAGE = 1 << 20;  // a two-hand frame is ~15 KB
+    constexpr size_t MAX_HANDSHAKE = 8192;
+    constexpr int MAX_DEPTH = 32;
+    constexpr float MM_TO_M = 0.001f;
+
+    /// Just enough JSON for v6 frames: no \u escapes beyond skipping them
+    struct Value {
+        enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
+        double number = 0.0;
+        std::string string;
+        std::vector<Value> items;
+        std::vector<std::pair<std::string, Value>> members;
+
+        [[nodiscard]] const Value* find(std::string_view key) const {
+            for (const auto& [name, value] : members) {
+                if (name == key) return &value;
+            }
+            return nullptr;
+        }
+    };
+
+    class Parser {
+    public:
+        explicit Parser(std::string_view text) : text(text) {}
+
+        bool parse(Value& out) {
+            if (!value(out, 0)) return false;
+            skipSpace();
+            return pos == text.size();
+        }
+
+    private:
+        void skipSpace() {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        }
+
+        bool consume(char c) {
+            skipSpace();
+            if (pos == text.size() || text[pos] != c) return false;
+            ++pos;
+            return true;
+        }
+
+        bool literal(std::string_view word) {
+            if (text.substr(pos, word.size()) != word) return false;
+            pos += word.size();
+            return true;
+        }
+
+        bool string(std::string& out) {
+            if (!consume('"')) return false;
+            while (pos < text.size() && text[pos] != '"') {
+                char c = text[pos++];
+                if (c == '\\') {
+                    if (pos == text.size()) return false;
+                    c = text[pos++];
+                    if (c == 'u') {
+                        pos += 4;
+                        c = '?';
+                    } else if (c == 'n') {
+                        c = '\n';
+                    } else if (c == 't') {
+                        c = '\t';
+                    }
+                }
+                out += c;
+            }
+            return pos++ < text.size();
+        }
+
+        bool value(Value& out, int depth) {
+            if (depth > MAX_DEPTH) return false;
+            skipSpace();
+            if (pos == text.size()) return false;
+            const char c = text[pos];
+            if (c == '{') {
+                ++pos;
+                out.type = Value::Type::Object;
+                if (consume('}')) return true;
+                do {
+                    auto& [name, member] = out.members.emplace_back();
+                    if (!string(name) || !consume(':') || !value(member, depth + 1)) return false;
+                } while (consume(','));
+                return consume('}');
+            }
+            if (c == '[') {
+                ++pos;
+                out.type = Value::Type::Array;
+                if (consume(']')) return true;
+                do {
+                    if (!value(out.items.emplace_back(), depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            }
+            if (c == '"') {
+                out.type = Value::Type::String;
+                return string(out.string);
+            }
+            if (literal("true") || literal("false")) {
+                out.type = Value::Type::Bool;
+                out.number = text[pos - 4] == 't';
+                return true;
+            }
+            if (literal("null")) return true;
+            out.type = Value::Type::Number;
+            const auto [end, error] = std::from_chars(text.data() + pos, text.data() + text.size(), out.number);
+            if (error != std::errc()) return false;
+            pos = size_t(end - text.data());
+            return true;
+        }
+
+        std::string_view text;
+        size_t pos = 0;
+    };
+
+    double number(const Value& object, std::string_view key) {
+        const Value* value = object.find(key);
+        return value && value->type == Value::Type::Number ? value->number : 0.0;
+    }
+
+    /// A [x, y, z] position in mm as meters
+    bool point(const Value& object, std::string_view key, xv::Point3f& out) {
+        const Value* value = object.find(key);
+        if (!value || value->items.size() != 3) return false;
+        for (size_t i = 0; i < 3; ++i) out[i] = float(value->items[i].number) * MM_TO_M;
+        return true;
+    }
+
+    bool sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += size_t(n);
+        }
+        return true;
+    }
+
+    bool sendText(int fd, std::string_view text) {
+        std::string frame;
+        ws::appendFrame(frame, ws::Opcode::Text, text.data(), text.size(), true);
+        return sendAll(fd, frame);
+    }
+}
+
+std::vector<xv::ExternalSample> parseFrame(std::string_view json, uint16_t source, int64_t hostTimeNs) {
+    Value frame;
+    if (!Parser(json).parse(frame)) return {};
+    const Value* hands = frame.find("hands");
+    if (!hands || hands->items.empty()) return {};
+    const Value* pointables = frame.find("pointables");
+
+    std::vector<xv::ExternalSample> samples;
+    for (const Value& hand : hands->items) {
+        xv::ExternalSample& sample = samples.emplace_back();
+        sample.sourceTimeUs = int64_t(number(frame, "timestamp"));
+        sample.hostTimeNs = hostTimeNs;
+        sample.source = source;
+        const Value* type = hand.find("type");
+        sample.kind = type && type->string == "right" ? KIND_RIGHT : KIND_LEFT;
+        sample.id = uint32_t(number(hand, "id"));
+        if (point(hand, "palmPosition", sample.points[0])) sample.pointCount = 1;
+
+        // Fingers in thumb-to-pinky order, whatever order the service lists them in
+        std::vector<const Value*> fingers;
+        for (size_t i = 0; pointables && i < pointables->items.size(); ++i) {
+            if (uint32_t(number(pointables->items[i], "handId")) == sample.id) fingers.push_back(&pointables->items[i]);
+        }
+        std::sort(fingers.begin(), fingers.end(),
+                  [](const Value* a, const Value* b) { return number(*a, "type") < number(*b, "type"); });
+        for (const Value* finger : fingers) {
+            for (const char* joint : {"mcpPosition", "pipPosition", "dipPosition", "tipPosition"}) {
+                if (sample.pointCount == xv::FUSION_MAX_POINTS) break;
+                if (point(*finger, joint, sample.points[sample.pointCount])) sample.pointCount++;
+            }
+        }
+    }
+    return samples;
+}
+
+bool Client::connect(int port) {
+    disconnect();
+    socketFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socketFd < 0) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(uint16_t(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // Loopback: connect() is answered at once, so it need not be non-blocking
+    if (::connect(socketFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        disconnect();
+        return false;
+    }
+    const int on = 1;
+    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    key = ws::clientKey();
+    const std::string request = "GET /v6.json HTTP/1.1\r\nHost: 127.0.0.1:" + std::to_string(port) +
+                                "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " + key +
+                                "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (!sendAll(socketFd, request)) {
+        disconnect();
+        return false;
+    }
+    fcntl(socketFd, F_SETFL, fcntl(socketFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void Client::disconnect() {
+    if (socketFd >= 0) close(socketFd);
+    socketFd = -1;
+    upgraded = false;
+    in.clear();
+}
+
+/// The 101 reply, checked against our key; then ask for frames while unfocused, tracked from a headset
+bool Client::handshake() {
+    const size_t end = in.find("\r\n\r\n");
+    if (end == std::string::npos) return in.size() <= MAX_HANDSHAKE;
+    std::string head = in.substr(0, end + 2);
+    in.erase(0, end + 4);
+    std::transform(head.begin(), head.end(), head.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    std::string expected = ws::acceptKey(key);
+    std::transform(expected.begin(), expected.end(), expected.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (head.compare(0, 12, "http/1.1 101") != 0 ||
+        head.find("sec-websocket-accept: " + expected + "\r\n") == std::string::npos) {
+        return false;
+    }
+    upgraded = true;
+    return sendText(socketFd, R"({"background": true})") && sendText(socketFd, R"({"optimizeHMD": true})");
+}
+
+bool Client::onReadable(const MessageHandler& onMessage) {
+    char buffer[16384];
+    while (true) {
+        const ssize_t n = recv(socketFd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) return false;
+        in.append(buffer, size_t(n));
+    }
+    if (!upgraded && !handshake()) return false;
+    if (!upgraded) return true;
+
+    ws::Frame frame;
+    long used;
+    size_t offset = 0;
+    const auto* data = reinterpret_cast<const uint8_t*>(in.data());
+    while ((used = ws::parseFrame(data + offset, in.size() - offset, frame, MAX_MESSAGE, true)) > 0) {
+        offset += size_t(used);
+        if (frame.opcode == ws::Opcode::Text && frame.fin) {
+            onMessage(frame.payload);
+        } else if (frame.opcode == ws::Opcode::Ping) {
+            std::string pong;
+            ws::appendFrame(pong, ws::Opcode::Pong, frame.payload.data(), frame.payload.size(), true);
+            if (!sendAll(socketFd, pong)) return false;
+        } else if (frame.opcode == ws::Opcode::Close) {
+            return false;
+        }
+    }
+    in.erase(0, offset);
+    return used >= 0;
+}
+
+} // namespace leap
@@ -0,0 +1,56 @@
+/**
+ * @file leap.h
+ * @brief Ultraleap tracking service client: WebSocket v6 JSON frames to fusion samples
+ */
+
+#ifndef XVISIO_LEAP_H
+#define XVISIO_LEAP_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fused_sample.h"
+
+namespace leap {
+
+inline constexpr uint16_t KIND_LEFT = 0;
+inline constexpr uint16_t KIND_RIGHT = 1;
+
+/**
+ * Hands of one v6 frame, in meters on the service's clock (frame "timestamp", µs).
+ * Points: palm, then MCP, PIP, DIP and tip of each finger from thumb to pinky.
+ * Non-frame messages (the service version greeting) give no samples.
+ */
+std::vector<xv::ExternalSample> parseFrame(std::string_view json, uint16_t source, int64_t hostTimeNs);
+
+/// Non-blocking WebSocket client of the local tracking service, driven by the caller's epoll loop
+class Client {
+public:
+    using MessageHandler = std::function<void (std::string_view text)>;
+
+    ~Client() { disconnect(); }
+
+    /// Connect and send the handshake; false if the service is not there
+    bool connect(int port);
+    void disconnect();
+
+    /// Socket to watch for EPOLLIN, -1 while disconnected
+    [[nodiscard]] int fd() const { return socketFd; }
+
+    /// Consume what arrived, handing over every text message. False once the connection is gone.
+    bool onReadable(const MessageHandler& onMessage);
+
+private:
+    bool handshake();
+
+    int socketFd = -1;
+    bool upgraded = false;
+    std::string key;
+    std::string in;
+};
+
+} // namespace leap
+
+#endif // XVISIO_LEAP_H
@@ -0,0 +1,626 @@
+/**
+ * XVisio WebSocket pose server
+ *
+ * All-in-one XR50 SLAM → WebSocket → browser, without the Node.js bridge: one
+ * epoll loop serves the visual-test build over HTTP and pushes the newest pose to
+ * every WebSocket client at a fixed rate. Poses come straight from a Slam ring.
+ *
+ * Binary messages follow pose_record.h: an 8-byte "XVPS" preamble message once,
+ * then one 36-byte record per message. --json sends xvisio_test's JSON line as a
+ * text message instead.
+ *
+ * A client that cannot keep up never builds a queue: a pose frame only goes out
+ * once the socket has (almost) nothing unsent (TCP_NOTSENT_LOWAT), and a newer
+ * pose replaces the one still waiting for it (latest wins).
+ * The device is opened again whenever it is missing or its stream ended.
+ * --smooth runs libxvisio's One Euro filter over every pose at the device rate,
+ * so the browser renders a clean pose without filtering its sparse samples.
+ *
+ * --leap reads hands from the local Ultraleap service (ws://127.0.0.1:6437/v6.json)
+ * and fuses them with the XR50: each hand is stamped on the XR50 clock, paired with
+ * the head pose at its capture time and placed in the world frame (PoseFusion).
+ * A WebSocket on /fusion gets an "XVFS" preamble, then per tick one message with a
+ * record for every hand seen in the last 100 ms. --fusion-shm also publishes every
+ * fused sample to shared memory (ShmFusionReader).
+ *
+ * Usage: sudo ./xvisio_server [--port 8080] [--rate HZ] [--json] [--smooth] [--dist DIR]
+ *                             [--leap] [--leap-mount X,Y,Z,QW,QX,QY,QZ] [--fusion-shm NAME]
+ *        Open http://localhost:8080
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "xvisio.h"
+#include "leap.h"
+#include "pose_fusion.h"
+#include "pose_json.h"
+#include "pose_record.h"
+#include "shm_publisher.h"
+#include "websocket.h"
+
+namespace {
+    std::atomic<bool> running{true};
+
+    constexpr uint8_t SLAM_TRANSFERS = 4;
+    constexpr size_t MAX_REQUEST_BYTES = 8192;
+    constexpr size_t MAX_CLIENT_FRAME = 4096;   // clients only send close/ping
+    constexpr int CLIENT_UNSENT_LIMIT = 256;     // TCP_NOTSENT_LOWAT: a few frames, so a queued pose is never old
+    constexpr auto DEVICE_RETRY = std::chrono::seconds(2);
+    constexpr auto STATS_INTERVAL = std::chrono::seconds(5);
+    constexpr int LEAP_PORT = 6437;
+    constexpr int64_t HAND_TIMEOUT_NS = 100'000'000;  // a hand unseen this long has left the view
+
+    struct Options {
+        int port = 8080;
+        int rateHz = 60;   // browsers render at 60 Hz; up to 1000 for the full device rate
+        bool json = false;
+        bool smooth = false;
+        std::filesystem::path dist;
+        bool leap = false;
+        xv::Extrinsics leapMount;  // Ultraleap origin and axes in the XR50 body frame
+        std::string fusionShm;
+    };
+
+    struct Client {
+        bool websocket = false;
+        bool fusion = false;  // connected on /fusion: fused records instead of poses
+        bool closeAfterFlush = false;
+        bool waitingWritable = false;  // EPOLLOUT armed
+        std::string in;       // request or client frames not parsed yet
+        std::string out;      // bytes that must leave in order: HTTP, handshake, control, a started frame
+        std::string latest;   // newest pose frame not started yet: replaced, never queued
+    };
+
+    struct Stats {
+        uint64_t poses = 0;
+        uint64_t sent = 0;
+        uint64_t replaced = 0;
+    };
+
+    int epollFd = -1;
+    std::unordered_map<int, Client> clients;
+    Stats stats;
+
+    // Device session
+    std::unique_ptr<xv::XVisio> xvisio;
+    std::shared_ptr<xv::Slam> slam;
+    std::shared_ptr<xv::PoseRing> ring;
+    xv::PoseFilterOptions smoothing;
+
+    // Hand fusion (--leap)
+    std::unique_ptr<xv::PoseFusion> fusion;
+    std::shared_ptr<xv::FusedRing> fusedRing;
+    std::unique_ptr<xv::ShmFusionPublisher> fusionShm;
+    leap::Client leapClient;
+    uint16_t leapSource = 0;
+    std::map<std::pair<uint16_t, uint32_t>, xv::FusedSample> hands;  // newest per (source, id)
+}
+
+void onSignal(int) {
+    running = false;
+}
+
+/** Find visual-test/dist from the usual working directories */
+std::filesystem::path findDist() {
+    for (const char* candidate : {"../visual-test/dist", "../../visual-test/dist", "visual-test/dist", "dist"}) {
+        if (std::filesystem::exists(std::filesystem::path(candidate) / "index.html")) {
+            return std::filesystem::canonical(candidate);
+        }
+    }
+    return {};
+}
+
+const char* mimeType(const std::filesystem::path& path) {
+    const std::string ext = path.extension().string();
+    if (ext == ".html") return "text/html; charset=utf-8";
+    if (ext == ".css") return "text/css";
+    if (ext == ".js" || ext == ".mjs") return "application/javascript";
+    if (ext == ".json") return "application/json";
+    if (ext == ".png") return "image/png";
+    if (ext == ".jpg" || ext == ".jpeg") return "image/jpeg";
+    if (ext == ".svg") return "image/svg+xml";
+    if (ext == ".woff2") return "font/woff2";
+    if (ext == ".glsl") return "text/plain";
+    return "application/octet-stream";
+}
+
+long websocketCount() {
+    return std::count_if(clients.begin(), clients.end(), [](const auto& entry) { return entry.second.websocket; });
+}
+
+void setWatch(int fd, bool writable) {
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | (writable ? EPOLLOUT : 0u);
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void closeClient(int fd) {
+    const auto it = clients.find(fd);
+    if (it == clients.end()) return;
+    const bool websocket = it->second.websocket;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    clients.erase(it);
+    if (websocket) std::cerr << "[WS] Client disconnected (" << websocketCount() << " left)" << std::endl;
+}
+
+/** Send what the socket takes. Returns false once the client should be closed. */
+bool flush(int fd, Client& client) {
+    while (true) {
+        if (client.out.empty()) {
+            if (client.latest.empty()) break;
+            client.out.swap(client.latest);
+            client.latest.clear();
+            stats.sent++;
+        }
+        const ssize_t n = send(fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!client.waitingWritable) setWatch(fd, true);
+            client.waitingWritable = true;
+            return true;
+        }
+        if (n <= 0) return false;
+        client.out.erase(0, size_t(n));
+    }
+    if (client.closeAfterFlush) return false;
+    if (client.waitingWritable) setWatch(fd, false);
+    client.waitingWritable = false;
+    return true;
+}
+
+void respond(Client& client, const char* status, const char* type, const std::string& body, bool withBody = true) {
+    std::ostringstream head;
+    head << "HTTP/1.1 " << status << "\r\nContent-Type: " << type << "\r\nContent-Length: " << body.size()
+         << "\r\nAccess-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n";
+    client.out += head.str();
+    if (withBody) client.out += body;
+    client.closeAfterFlush = true;
+}
+
+void serveFile(Client& client, const Options& options, const std::string& method, std::string target) {
+    if (method != "GET" && method != "HEAD") return respond(client, "405 Method Not Allowed", "text/plain", "");
+    target = target.substr(0, target.find_first_of("?#"));
+    if (target.empty() || target == "/") target = "/index.html";
+    // Relative to dist only: no parent steps, no "//" turning it absolute
+    if (target[0] != '/' || target.find("..") != std::string::npos || target.find("//") != std::string::npos) {
+        return respond(client, "403 Forbidden", "text/plain", "Forbidden");
+    }
+
+    // Exact file, else the single-page app's index.html
+    for (const auto& path : {options.dist / target.substr(1), options.dist / "index.html"}) {
+        std::ifstream file(path, std::ios::binary);
+        if (options.dist.empty() || !file || std::filesystem::is_directory(path)) continue;
+        const std::string body{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        return respond(client, "200 OK", mimeType(path), body, method == "GET");
+    }
+    respond(client, "404 Not Found", "text/plain", "Not found. Run `npm run build` in visual-test first.");
+}
+
+/** A complete HTTP request head: upgrade to WebSocket or serve a file */
+void handleRequest(Client& client, const Options& options, const std::string& head) {
+    std::istringstream lines(head);
+    std::string method, target, line;
+    lines >> method >> target;
+    std::getline(lines, line);
+
+    std::unordered_map<std::string, std::string> headers;
+    while (std::getline(lines, line) && line != "\r") {
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        const size_t start = line.find_first_not_of(' ', colon + 1);
+        const size_t end = line.find_last_not_of("\r ");
+        headers[name] = start <= end ? line.substr(start, end - start + 1) : "";
+    }
+
+    std::string upgrade = headers["upgrade"];
+    std::transform(upgrade.begin(), upgrade.end(), upgrade.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (upgrade != "websocket" || headers["sec-websocket-key"].empty()) {
+        return serveFile(client, options, method, target);
+    }
+
+    client.out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: " + ws::acceptKey(headers["sec-websocket-key"]) + "\r\n\r\n";
+    client.fusion = target.substr(0, target.find_first_of("?#")) == "/fusion";
+    if (client.fusion) {
+        const auto preamble = xv::record::fusedPreamble();
+        ws::appendFrame(client.out, ws::Opcode::Binary, preamble.data(), preamble.size());
+    } else if (!options.json) {
+        const auto preamble = xv::record::preamble();
+        ws::appendFrame(client.out, ws::Opcode::Binary, preamble.data(), preamble.size());
+    }
+    client.websocket = true;
+    std::cerr << "[WS] Client connected (" << websocketCount() << " total)" << std::endl;
+}
+
+/** Frames from a WebSocket client: answer ping and close, ignore the rest */
+bool handleFrames(Client& client) {
+    ws::Frame frame;
+    long used;
+    size_t offset = 0;
+    const auto* data = reinterpret_cast<const uint8_t*>(client.in.data());
+    while ((used = ws::parseFrame(data + offset, client.in.size() - offset, frame, MAX_CLIENT_FRAME)) > 0) {
+        offset += size_t(used);
+        if (frame.opcode == ws::Opcode::Ping) {
+            ws::appendFrame(client.out, ws::Opcode::Pong, frame.payload.data(), frame.payload.size());
+        } else if (frame.opcode == ws::Opcode::Close) {
+            ws::appendFrame(client.out, ws::Opcode::Close, frame.payload.data(), std::min<size_t>(frame.payload.size(), 2));
+            client.latest.clear();
+            client.closeAfterFlush = true;
+            break;
+        }
+    }
+    client.in.erase(0, offset);
+    return used >= 0;
+}
+
+void onReadable(int fd, const Options& options) {
+    Client& client = clients[fd];
+    char buffer[4096];
+    while (true) {
+        const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) return closeClient(fd);
+        client.in.append(buffer, size_t(n));
+    }
+    if (client.closeAfterFlush) {
+        client.in.clear();
+    } else if (client.websocket) {
+        if (!handleFrames(client)) return closeClient(fd);
+    } else if (const size_t end = client.in.find("\r\n\r\n"); end != std::string::npos) {
+        const std::string head = client.in.substr(0, end + 2);
+        client.in.erase(0, end + 4);
+        handleRequest(client, options, head);
+        if (client.websocket) {
+            // Writable only while next to nothing is unsent: backpressure after a few poses, not seconds of them
+            setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &CLIENT_UNSENT_LIMIT, sizeof(CLIENT_UNSENT_LIMIT));
+            if (!handleFrames(client)) return closeClient(fd);
+        }
+    } else if (client.in.size() > MAX_REQUEST_BYTES) {
+        respond(client, "431 Request Header Fields Too Large", "text/plain", "");
+    }
+    if (!flush(fd, client)) closeClient(fd);
+}
+
+void acceptClients(int listenFd) {
+    while (true) {
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;  // EAGAIN, or out of descriptors until someone leaves
+        }
+        const int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        clients[fd];
+    }
+}
+
+/** Hand a frame to every WebSocket client of one kind, replacing one it has not started on */
+void offer(const std::string& frame, bool toFusion) {
+    for (auto& [fd, client] : clients) {
+        if (!client.websocket || client.closeAfterFlush || client.fusion != toFusion) continue;
+        if (!client.latest.empty()) stats.replaced++;
+        client.latest = frame;
+        // Sent once EPOLLOUT reports the unsent backlog below the low-water mark; until
+        // then a newer frame takes its place
+        if (!client.waitingWritable) {
+            setWatch(fd, true);
+            client.waitingWritable = true;
+        }
+    }
+}
+
+/** Hand every pose client the newest pose */
+void broadcast(const xv::RawPose& pose, const Options& options) {
+    std::string frame;
+    if (options.json) {
+        std::ostringstream line;
+        writePoseJson(line, pose);
+        std::string text = line.str();
+        text.pop_back();  // one message per pose: no newline
+        ws::appendFrame(frame, ws::Opcode::Text, text.data(), text.size());
+    } else {
+        const auto record = xv::record::encode(pose);
+        ws::appendFrame(frame, ws::Opcode::Binary, record.data(), record.size());
+    }
+    offer(frame, false);
+}
+
+/** Newest fused sample of every hand still in view, as one message to every fusion client */
+void broadcastHands(int64_t nowNs) {
+    xv::FusedSample sample;
+    bool changed = false;
+    while (fusedRing && fusedRing->tryPop(sample)) {
+        hands[{sample.source, sample.id}] = sample;
+        changed = true;
+    }
+    changed |= std::erase_if(hands, [nowNs](const auto& entry) {
+        return nowNs - entry.second.hostTimeNs > HAND_TIMEOUT_NS;
+    }) > 0;
+    if (!changed) return;
+
+    std::string payload;
+    for (const auto& [key, hand] : hands) {
+        const auto record = xv::record::encode(hand);
+        payload.append(reinterpret_cast<const char*>(record.data()), record.size());
+    }
+    std::string frame;
+    ws::appendFrame(frame, ws::Opcode::Binary, payload.data(), payload.size());
+    offer(frame, true);
+}
+
+void onLeapMessage(std::string_view text) {
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (const auto& sample : leap::parseFrame(text, leapSource, nowNs)) fusion->push(sample);
+}
+
+void disconnectLeap() {
+    if (leapClient.fd() < 0) return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, leapClient.fd(), nullptr);
+    leapClient.disconnect();
+    hands.clear();
+    std::cerr << "[Leap] Disconnected" << std::endl;
+}
+
+bool connectLeap() {
+    if (!leapClient.connect(LEAP_PORT)) return false;
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = leapClient.fd();
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, leapClient.fd(), &event);
+    std::cerr << "[Leap] Connected to the tracking service" << std::endl;
+    return true;
+}
+
+/** "X,Y,Z,QW,QX,QY,QZ": mount position in meters and orientation */
+bool parseMount(const char* text, xv::Extrinsics& out) {
+    double values[7];
+    std::istringstream in(text);
+    for (int i = 0; i < 7; ++i) {
+        if (!(in >> values[i]) || (i < 6 && in.get() != ',')) return false;
+    }
+    out.translation = {values[0], values[1], values[2]};
+    out.rotation = {values[3], values[4], values[5], values[6]};
+    return in.peek() == EOF;
+}
+
+void closeDevice() {
+    if (slam) slam->stop();
+    slam.reset();
+    ring.reset();
+    xvisio.reset();
+}
+
+bool openDevice() {
+    try {
+        xvisio = std::make_unique<xv::XVisio>();
+        const auto& devices = xvisio->getDevices();
+        if (devices.empty()) {
+            xvisio.reset();
+            return false;
+        }
+        const auto& device = devices[0];
+        std::cerr << "[XR50] UUID:     " << device->getUUID() << std::endl;
+        std::cerr << "[XR50] Firmware: " << device->getVersion() << std::endl;
+        slam = device->getSlam();
+        slam->setAutoReconnect(true);
+        ring = slam->openPoseRing();
+        slam->setSmoothing(smoothing);
+        slam->start(xv::Slam::mode::Edge, SLAM_TRANSFERS);
+        std::cerr << "[XR50] Streaming SLAM data to WebSocket clients..." << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[XR50] " << e.what() << std::endl;
+        closeDevice();
+        return false;
+    }
+}
+
+int listenOn(int port) {
+    const int fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    const int on = 1, off = 0;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));  // IPv4 clients too
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(uint16_t(port));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--port N] [--rate HZ] [--json] [--smooth] [--dist DIR]"
+              << " [--leap] [--leap-mount X,Y,Z,QW,QX,QY,QZ] [--fusion-shm NAME]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            options.rateHz = std::clamp(std::atoi(argv[++i]), 1, 1000);
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (std::strcmp(argv[i], "--smooth") == 0) {
+            options.smooth = true;
+        } else if (std::strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+            options.dist = argv[++i];
+        } else if (std::strcmp(argv[i], "--leap") == 0) {
+            options.leap = true;
+        } else if (std::strcmp(argv[i], "--leap-mount") == 0 && i + 1 < argc) {
+            if (!parseMount(argv[++i], options.leapMount)) return usage(argv[0]);
+        } else if (std::strcmp(argv[i], "--fusion-shm") == 0 && i + 1 < argc) {
+            options.fusionShm = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    smoothing.enabled = options.smooth;
+    if (options.dist.empty()) options.dist = findDist();
+    if (options.dist.empty()) {
+        std::cerr << "[HTTP] visual-test/dist not found (use --dist); HTTP will return 404" << std::endl;
+    } else {
+        std::cerr << "[HTTP] Serving static files from " << options.dist.string() << std::endl;
+    }
+
+    if (options.leap) {
+        // Head poses from whichever session is open; the history is read on this thread
+        fusion = std::make_unique<xv::PoseFusion>([](int64_t hostTimeNs) -> std::optional<xv::Pose> {
+            return slam ? slam->sampleAt(hostTimeNs) : std::nullopt;
+        });
+        leapSource = fusion->addSource(options.leapMount);
+        fusedRing = fusion->openFusedRing();
+        try {
+            if (!options.fusionShm.empty()) fusionShm = std::make_unique<xv::ShmFusionPublisher>(*fusion, options.fusionShm);
+        } catch (const std::exception& e) {
+            std::cerr << "[Leap] " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    const int listenFd = listenOn(options.port);
+    if (listenFd < 0) {
+        std::cerr << "Cannot listen on port " << options.port << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // Every tick sends the newest pose, if there is one
+    const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    itimerspec tick{};
+    tick.it_interval.tv_nsec = 1000000000L / options.rateHz;
+    if (options.rateHz == 1) tick.it_interval = {1, 0};
+    tick.it_value = tick.it_interval;
+    timerfd_settime(timerFd, 0, &tick, nullptr);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    for (const int fd : {listenFd, timerFd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+    std::cerr << "[HTTP] http://localhost:" << options.port << " (" << options.rateHz << " Hz, "
+              << (options.json ? "JSON" : "binary") << (options.smooth ? ", smoothed" : "") << " poses)" << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    auto nextDeviceTry = Clock::now();
+    auto nextLeapTry = Clock::now();
+    auto nextStats = Clock::now() + STATS_INTERVAL;
+    int64_t lastSentUs = -1;
+
+    epoll_event events[64];
+    while (running) {
+        const int count = epoll_wait(epollFd, events, 64, 500);
+        if (count < 0 && errno != EINTR) break;
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients(listenFd);
+            } else if (fd == timerFd) {
+                uint64_t expirations;
+                [[maybe_unused]] const ssize_t n = read(timerFd, &expirations, sizeof(expirations));
+                xv::RawPose pose, newest;
+                bool fresh = false;
+                while (ring && ring->tryPop(pose)) {
+                    newest = pose;
+                    fresh = true;
+                    stats.poses++;
+                }
+                if (fresh && newest.timeUs != lastSentUs) {
+                    lastSentUs = newest.timeUs;
+                    broadcast(newest, options);
+                }
+                if (fusion) {
+                    broadcastHands(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now().time_since_epoch()).count());
+                }
+            } else if (fd == leapClient.fd() && fd >= 0) {
+                if (!leapClient.onReadable(onLeapMessage)) {
+                    disconnectLeap();
+                    nextLeapTry = Clock::now() + DEVICE_RETRY;
+                }
+            } else if (clients.count(fd)) {
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeClient(fd);
+                } else if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                    onReadable(fd, options);
+                } else if (events[i].events & EPOLLOUT) {
+                    if (!flush(fd, clients[fd])) closeClient(fd);
+                }
+            }
+        }
+
+        const auto now = Clock::now();
+        if ((!slam || !slam->running()) && now >= nextDeviceTry) {
+            if (slam) {
+                std::cerr << "[XR50] Stream ended, reopening the device" << std::endl;
+                closeDevice();
+            }
+            if (!openDevice()) nextDeviceTry = now + DEVICE_RETRY;
+        }
+        if (fusion && leapClient.fd() < 0 && now >= nextLeapTry && !connectLeap()) nextLeapTry = now + DEVICE_RETRY;
+        if (now >= nextStats) {
+            const double seconds = std::chrono::duration<double>(STATS_INTERVAL).count();
+            std::cerr << "[XR50] " << stats.poses / seconds << " poses/s, " << stats.sent / seconds
+                      << " frames/s sent, " << stats.replaced << " replaced, " << websocketCount() << " client(s)"
+                      << std::endl;
+            if (fusion) {
+                std::cerr << "[Leap] " << fusion->fused() << " hands fused, " << fusion->unaligned()
+                          << " without a head pose, " << fusion->sourceLatency(leapSource) / 1000 << " µs receive delay"
+                          << std::endl;
+            }
+            stats = {};
+            nextStats = now + STATS_INTERVAL;
+        }
+    }
+
+    std::cerr << "[XR50] Shutting down" << std::endl;
+    disconnectLeap();
+    closeDevice();
+    while (!clients.empty()) closeClient(clients.begin()->first);
+    close(timerFd);
+    close(listenFd);
+    close(epollFd);
+    return 0;
+}
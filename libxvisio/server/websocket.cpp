@@ -0,0 +1,161 @@
+/**
+ * @file websocket.cpp
+ * @brief SHA-1 and base64 for the handshake, frame encoding and decoding
+ */
+
+#include "websocket.h"
+#include <array>
+#include <random>
+
+namespace ws {
+
+namespace {
+    constexpr std::string_view HANDSHAKE_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+    uint32_t rotl(uint32_t value, int bits) {
+        return value << bits | value >> (32 - bits);
+    }
+
+    /// FIPS 180-4 SHA-1; only ever hashes a 60-byte handshake string
+    std::array<uint8_t, 20> sha1(std::string_view message) {
+        uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+        std::string padded(message);
+        padded += char(0x80);
+        while (padded.size() % 64 != 56) padded += char(0);
+        const uint64_t bits = uint64_t(message.size()) * 8;
+        for (int i = 7; i >= 0; --i) padded += char(bits >> (8 * i));
+
+        for (size_t block = 0; block < padded.size(); block += 64) {
+            uint32_t w[80];
+            for (int i = 0; i < 16; ++i) {
+                const auto* p = reinterpret_cast<const uint8_t*>(padded.data() + block + 4 * i);
+                w[i] = uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+            }
+            for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+            for (int i = 0; i < 80; ++i) {
+                uint32_t f, k;
+                if (i < 20) {
+                    f = (b & c) | (~b & d);
+                    k = 0x5a827999;
+                } else if (i < 40) {
+                    f = b ^ c ^ d;
+                    k = 0x6ed9eba1;
+                } else if (i < 60) {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8f1bbcdc;
+                } else {
+                    f = b ^ c ^ d;
+                    k = 0xca62c1d6;
+                }
+                const uint32_t next = rotl(a, 5) + f + e + k + w[i];
+                e = d;
+                d = c;
+                c = rotl(b, 30);
+                b = a;
+                a = next;
+            }
+            h[0] += a;
+            h[1] += b;
+            h[2] += c;
+            h[3] += d;
+            h[4] += e;
+        }
+
+        std::array<uint8_t, 20> digest{};
+        for (int i = 0; i < 20; ++i) digest[i] = uint8_t(h[i / 4] >> (24 - 8 * (i % 4)));
+        return digest;
+    }
+
+    std::mt19937& random() {
+        static std::mt19937 generator{std::random_device{}()};
+        return generator;
+    }
+
+    std::string base64(const uint8_t* data, size_t size) {
+        static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        for (size_t i = 0; i < size; i += 3) {
+            const uint32_t chunk = uint32_t(data[i]) << 16 | (i + 1 < size ? uint32_t(data[i + 1]) << 8 : 0) |
+                                   (i + 2 < size ? data[i + 2] : 0);
+            out += ALPHABET[chunk >> 18 & 63];
+            out += ALPHABET[chunk >> 12 & 63];
+            out += i + 1 < size ? ALPHABET[chunk >> 6 & 63] : '=';
+            out += i + 2 < size ? ALPHABET[chunk & 63] : '=';
+        }
+        return out;
+    }
+}
+
+std::string acceptKey(std::string_view clientKey) {
+    std::string joined(clientKey);
+    joined += HANDSHAKE_GUID;
+    const auto digest = sha1(joined);
+    return base64(digest.data(), digest.size());
+}
+
+std::string clientKey() {
+    uint8_t nonce[16];
+    for (auto& byte : nonce) byte = uint8_t(random()());
+    return base64(nonce, sizeof(nonce));
+}
+
+void appendFrame(std::string& out, Opcode opcode, const void* payload, size_t size, bool masked) {
+    const uint8_t maskBit = masked ? 0x80 : 0;
+    out += char(0x80 | uint8_t(opcode));
+    if (size < 126) {
+        out += char(size | maskBit);
+    } else if (size <= 0xffff) {
+        out += char(126 | maskBit);
+        out += char(size >> 8);
+        out += char(size);
+    } else {
+        out += char(127 | maskBit);
+        for (int i = 7; i >= 0; --i) out += char(uint64_t(size) >> (8 * i));
+    }
+    const auto* bytes = static_cast<const char*>(payload);
+    if (!masked) {
+        out.append(bytes, size);
+        return;
+    }
+
+    const uint32_t key = random()();
+    const char mask[4] = {char(key), char(key >> 8), char(key >> 16), char(key >> 24)};
+    out.append(mask, 4);
+    for (size_t i = 0; i < size; ++i) out += char(bytes[i] ^ mask[i % 4]);
+}
+
+long parseFrame(const uint8_t* data, size_t size, Frame& out, size_t maxPayload, bool fromServer) {
+    if (size < 2) return 0;
+    const bool masked = data[1] & 0x80;
+    if (masked == fromServer) return -1;  // clients must mask, servers must not (RFC 6455 §5.1)
+
+    uint64_t length = data[1] & 0x7f;
+    size_t header = 2;
+    if (length == 126) {
+        if (size < 4) return 0;
+        length = uint64_t(data[2]) << 8 | data[3];
+        header = 4;
+    } else if (length == 127) {
+        if (size < 10) return 0;
+        length = 0;
+        for (int i = 0; i < 8; ++i) length = length << 8 | data[2 + i];
+        header = 10;
+    }
+    if (length > maxPayload) return -1;
+    const size_t maskSize = masked ? 4 : 0;
+    if (size < header + maskSize + length) return 0;
+
+    static constexpr uint8_t NO_MASK[4] = {};
+    const uint8_t* mask = masked ? data + header : NO_MASK;
+    const uint8_t* payload = data + header + maskSize;
+    out.opcode = Opcode(data[0] & 0x0f);
+    out.fin = data[0] & 0x80;
+    out.payload.resize(length);
+    for (size_t i = 0; i < length; ++i) out.payload[i] = char(payload[i] ^ mask[i % 4]);
+    return long(header + maskSize + length);
+}
+
+} // namespace ws
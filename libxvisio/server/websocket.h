@@ -0,0 +1,47 @@
+/**
+ * @file websocket.h
+ * @brief The RFC 6455 pieces xvisio_server needs: handshake keys, frame encoding and parsing for both ends
+ */
+
+#ifndef XVISIO_WEBSOCKET_H
+#define XVISIO_WEBSOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ws {
+
+enum class Opcode : uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xa,
+};
+
+/// Sec-WebSocket-Accept value for a client's Sec-WebSocket-Key
+std::string acceptKey(std::string_view clientKey);
+
+/// Random Sec-WebSocket-Key for connecting to a server
+std::string clientKey();
+
+/// Append one final frame to out: unmasked from a server, masked from a client
+void appendFrame(std::string& out, Opcode opcode, const void* payload, size_t size, bool masked = false);
+
+struct Frame {
+    Opcode opcode = Opcode::Continuation;
+    bool fin = false;
+    std::string payload;  ///< unmasked
+};
+
+/// Parse one frame from the front of data: masked from a client, unmasked when fromServer.
+/// Returns the bytes consumed, 0 while incomplete, or -1 on a protocol error
+/// (wrong masking or payload above maxPayload).
+long parseFrame(const uint8_t* data, size_t size, Frame& out, size_t maxPayload, bool fromServer = false);
+
+} // namespace ws
+
+#endif // XVISIO_WEBSOCKET_H
@@ -0,0 +1,317 @@
+/**
+ * XVisio soak test
+ *
+ * Streams from a simulated XR50 (sim_usb.h) through the real XVisio, Device and
+ * Slam code, injecting stalls, wedged endpoints, transfer timeouts and unplugs
+ * at random, and reports throughput, frames lost (steady state and per fault),
+ * recovery time, restarts after the recovery limit, CPU use and peak RSS.
+ * Slam's own recovery (clear_halt, MAX_RECOVERY_ATTEMPTS, hot reconnect) does
+ * all the work; a session it gives up on is restarted here, like xvisio_test.
+ *
+ * Usage: ./xvisio_soak [--duration S] [--rate HZ] [--fault-interval S] [--faults LIST]
+ *                      [--wedge N] [--unplug-ms MS] [--transfers N] [--report S]
+ *                      [--max-steady-loss PCT] [--max-recovery S] [--seed N] [--quiet]
+ *        --duration 0 runs until Ctrl+C. LIST is any of stall,wedge,timeout,unplug.
+ *        Exits 1 if a fault was not recovered from within --max-recovery seconds
+ *        or more than --max-steady-loss percent of frames were lost outside faults.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include "logging.h"
+#include "sim_usb.h"
+#include "xvisio.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> running{true};
+
+    struct Options {
+        double durationS = 60.0;
+        double rateHz = 1000.0;
+        double faultIntervalS = 5.0;
+        std::vector<sim::Fault> faults{sim::Fault::Stall, sim::Fault::Wedge, sim::Fault::Timeout, sim::Fault::Unplug};
+        int wedgeRefusals = 4;  // up to; 3 or more exhausts Slam's recovery attempts
+        int unplugMs = 500;
+        int transfers = 4;
+        double reportS = 10.0;
+        double maxSteadyLossPct = 0.1;
+        double maxRecoveryS = 15.0;
+        unsigned seed = 1;
+        bool quiet = false;
+    };
+
+    double seconds(Clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+    /// User plus system CPU time of the whole process
+    double cpuSeconds() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+               double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+    }
+
+    double peakRssMb() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return double(usage.ru_maxrss) / 1024.0;  // KiB on Linux
+    }
+
+    std::string clockTime(double s) {
+        const auto total = long(s);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%02ld:%02ld:%02ld", total / 3600, total / 60 % 60, total % 60);
+        return text;
+    }
+
+    bool parseFaults(const char* list, std::vector<sim::Fault>& faults) {
+        faults.clear();
+        std::string rest = list;
+        while (!rest.empty()) {
+            const auto comma = rest.find(',');
+            const std::string item = rest.substr(0, comma);
+            rest = comma == std::string::npos ? "" : rest.substr(comma + 1);
+            bool known = false;
+            for (size_t i = 0; i < sim::FAULT_KINDS; ++i) {
+                if (item == sim::name(sim::Fault(i))) {
+                    faults.push_back(sim::Fault(i));
+                    known = true;
+                }
+            }
+            if (!known) return false;
+        }
+        return true;
+    }
+
+    int usage(const char* argv0) {
+        std::fprintf(stderr,
+                     "Usage: %s [--duration S] [--rate HZ] [--fault-interval S] [--faults stall,wedge,timeout,unplug]\n"
+                     "       [--wedge N] [--unplug-ms MS] [--transfers N] [--report S] [--max-steady-loss PCT]\n"
+                     "       [--max-recovery S] [--seed N] [--quiet]\n",
+                     argv0);
+        return 1;
+    }
+
+    /// Periodic one-liner: the window since the last one, plus totals
+    struct Reporter {
+        Clock::time_point started = Clock::now();
+        Clock::time_point last = started;
+        double startCpu = cpuSeconds();
+        double lastCpu = startCpu;
+        uint64_t lastDelivered = 0;
+
+        void line(const sim::Stats& s, uint64_t restarts) {
+            const auto now = Clock::now();
+            const double window = std::max(seconds(now - last), 1e-9);
+            const double cpu = cpuSeconds();
+            uint64_t faults = 0, recovered = 0, maxUs = 0, totalUs = 0;
+            for (size_t i = 0; i < sim::FAULT_KINDS; ++i) {
+                faults += s.injected[i];
+                recovered += s.recoveries[i].count;
+                totalUs += s.recoveries[i].totalUs;
+                maxUs = std::max(maxUs, s.recoveries[i].maxUs);
+            }
+            std::fprintf(stderr,
+                         "[soak] %s | %.1f Hz | lost %llu (%.3f%%, steady %llu) | faults %llu, recovered %llu "
+                         "(mean %.1f ms, max %.1f ms) | restarts %llu | cpu %.1f%% | rss %.1f MB\n",
+                         clockTime(seconds(now - started)).c_str(), double(s.delivered - lastDelivered) / window,
+                         (unsigned long long)s.lostTotal(), s.ticks ? 100.0 * double(s.lostTotal()) / double(s.ticks) : 0.0,
+                         (unsigned long long)s.steadyLost, (unsigned long long)faults, (unsigned long long)recovered,
+                         recovered ? totalUs / 1000.0 / double(recovered) : 0.0, maxUs / 1000.0,
+                         (unsigned long long)restarts, 100.0 * (cpu - lastCpu) / window, peakRssMb());
+            last = now;
+            lastCpu = cpu;
+            lastDelivered = s.delivered;
+        }
+    };
+
+    /// Stream counters restart with every session; keep the sum across restarts
+    void accumulate(xv::SlamMetrics& total, const xv::SlamMetrics& session) {
+        for (size_t i = 0; i < total.transferErrors.size(); ++i) total.transferErrors[i] += session.transferErrors[i];
+        for (size_t i = 0; i < total.rejectedPackets.size(); ++i) total.rejectedPackets[i] += session.rejectedPackets[i];
+        total.recoveryAttempts += session.recoveryAttempts;
+        total.recoveries += session.recoveries;
+        total.reconnects = session.reconnects;  // already cumulative
+    }
+
+    void summary(const sim::Stats& s, const xv::SlamMetrics& m, uint64_t received, uint64_t restarts,
+                 const Reporter& reporter) {
+        const double elapsed = seconds(Clock::now() - reporter.started);
+        std::fprintf(stderr, "\n[soak] %s, %llu frame ticks, %llu delivered, %llu received by the hub\n",
+                     clockTime(elapsed).c_str(), (unsigned long long)s.ticks, (unsigned long long)s.delivered,
+                     (unsigned long long)received);
+        std::fprintf(stderr, "[soak] lost %llu (%.3f%%), %llu of them outside faults:", (unsigned long long)s.lostTotal(),
+                     s.ticks ? 100.0 * double(s.lostTotal()) / double(s.ticks) : 0.0,
+                     (unsigned long long)s.steadyLost);
+        for (size_t i = 0; i < sim::LOSS_KINDS; ++i) {
+            std::fprintf(stderr, "%s %s %llu", i ? "," : "", sim::name(sim::Loss(i)), (unsigned long long)s.lost[i]);
+        }
+        std::fprintf(stderr, "\n");
+        for (size_t i = 0; i < sim::FAULT_KINDS; ++i) {
+            const auto& r = s.recoveries[i];
+            if (!s.injected[i]) continue;
+            std::fprintf(stderr, "[soak] %-7s %4llu injected, %4llu recovered, mean %7.1f ms, max %7.1f ms, %llu frames lost\n",
+                         sim::name(sim::Fault(i)), (unsigned long long)s.injected[i], (unsigned long long)r.count,
+                         r.meanMs(), r.maxUs / 1000.0, (unsigned long long)r.framesLost);
+        }
+        uint64_t transferErrors = 0, rejected = 0;
+        for (const uint64_t count : m.transferErrors) transferErrors += count;
+        for (const uint64_t count : m.rejectedPackets) rejected += count;
+        std::fprintf(stderr,
+                     "[soak] Slam: %llu transfer errors, %llu recovery attempts, %llu recoveries, %llu reconnects, "
+                     "%llu restarts after giving up, %llu clear_halt calls, %llu refused submits, %llu rejected packets\n",
+                     (unsigned long long)transferErrors, (unsigned long long)m.recoveryAttempts,
+                     (unsigned long long)m.recoveries, (unsigned long long)m.reconnects, (unsigned long long)restarts,
+                     (unsigned long long)s.clearHalts, (unsigned long long)s.refusedSubmits,
+                     (unsigned long long)rejected);
+        std::fprintf(stderr, "[soak] cpu %.1f%% of one core on average, peak rss %.1f MB\n",
+                     100.0 * (cpuSeconds() - reporter.startCpu) / std::max(elapsed, 1e-9), peakRssMb());
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--duration" && hasValue) {
+            options.durationS = std::atof(argv[++i]);
+        } else if (arg == "--rate" && hasValue) {
+            options.rateHz = std::atof(argv[++i]);
+            if (options.rateHz <= 0.0) return usage(argv[0]);
+        } else if (arg == "--fault-interval" && hasValue) {
+            options.faultIntervalS = std::atof(argv[++i]);
+            if (options.faultIntervalS <= 0.0) return usage(argv[0]);
+        } else if (arg == "--faults" && hasValue) {
+            if (!parseFaults(argv[++i], options.faults)) return usage(argv[0]);
+        } else if (arg == "--wedge" && hasValue) {
+            options.wedgeRefusals = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--unplug-ms" && hasValue) {
+            options.unplugMs = std::max(std::atoi(argv[++i]), 0);
+        } else if (arg == "--transfers" && hasValue) {
+            options.transfers = std::clamp(std::atoi(argv[++i]), 1, 32);
+        } else if (arg == "--report" && hasValue) {
+            options.reportS = std::atof(argv[++i]);
+            if (options.reportS <= 0.0) return usage(argv[0]);
+        } else if (arg == "--max-steady-loss" && hasValue) {
+            options.maxSteadyLossPct = std::atof(argv[++i]);
+        } else if (arg == "--max-recovery" && hasValue) {
+            options.maxRecoveryS = std::atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--quiet") {
+            options.quiet = true;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    std::signal(SIGINT, [](int) { running = false; });
+    std::signal(SIGTERM, [](int) { running = false; });
+    // Every fault is logged by Slam; over hours that is mostly noise
+    if (options.quiet) xv::log::setLevel(xv::log::Level::Error);
+
+    sim::configure({options.rateHz, std::chrono::milliseconds(options.unplugMs)});
+    std::mt19937 random(options.seed);
+    auto nextGap = [&] {
+        std::uniform_real_distribution<double> spread(0.5, 1.5);
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.faultIntervalS * spread(random)));
+    };
+
+    xv::XVisio xvisio;
+    const auto& devices = xvisio.getDevices();
+    if (devices.empty()) {
+        std::fprintf(stderr, "[soak] The simulated device did not enumerate\n");
+        return 1;
+    }
+    const auto slam = devices[0]->getSlam();
+    slam->setAutoReconnect(true);
+    std::atomic<uint64_t> received{0};
+    slam->registerPacketTap([&received](const uint8_t*, int, int64_t) {
+        received.store(received.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    });
+    slam->start(xv::Slam::mode::Edge, uint8_t(options.transfers));
+    std::fprintf(stderr, "[soak] %.0f Hz, a fault every ~%.1f s (", options.rateHz, options.faultIntervalS);
+    for (size_t i = 0; i < options.faults.size(); ++i) {
+        std::fprintf(stderr, "%s%s", i ? ", " : "", sim::name(options.faults[i]));
+    }
+    std::fprintf(stderr, "), %d transfers\n", options.transfers);
+
+    Reporter reporter;
+    const auto until = options.durationS > 0.0
+                           ? reporter.started + std::chrono::duration_cast<Clock::duration>(
+                                                    std::chrono::duration<double>(options.durationS))
+                           : Clock::time_point::max();
+    const auto reportEvery = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.reportS));
+    const auto recoveryLimit =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.maxRecoveryS));
+    auto nextReport = reporter.started + reportEvery;
+    auto nextFault = reporter.started + nextGap();
+    auto injectedAt = Clock::time_point{};
+    xv::SlamMetrics metrics;
+    uint64_t restarts = 0;
+    bool stuck = false;
+
+    while (running && Clock::now() < until && !stuck) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const auto now = Clock::now();
+        const sim::Stats stats = sim::stats();
+
+        // Past MAX_RECOVERY_ATTEMPTS Slam stops; start a fresh session as an application would
+        if (!slam->running()) {
+            restarts++;
+            accumulate(metrics, slam->getMetrics());
+            try {
+                slam->stop();
+                slam->start(xv::Slam::mode::Edge, uint8_t(options.transfers));
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "[soak] Restart failed: %s\n", e.what());
+            }
+        }
+
+        if (stats.recovering) {
+            if (now - injectedAt > recoveryLimit) {
+                std::fprintf(stderr, "[soak] No frame %.1f s after the last fault\n", seconds(now - injectedAt));
+                stuck = true;
+            }
+        } else if (!options.faults.empty() && now >= nextFault) {
+            std::uniform_int_distribution<size_t> pick(0, options.faults.size() - 1);
+            std::uniform_int_distribution<int> refusals(1, options.wedgeRefusals);
+            if (sim::inject(options.faults[pick(random)], refusals(random))) injectedAt = now;
+            nextFault = now + nextGap();
+        }
+
+        if (now >= nextReport) {
+            reporter.line(stats, restarts);
+            nextReport += reportEvery;
+        }
+    }
+
+    const sim::Stats stats = sim::stats();
+    accumulate(metrics, slam->getMetrics());
+    slam->stop();
+    summary(stats, metrics, received.load(), restarts, reporter);
+
+    const double steadyLossPct = stats.ticks ? 100.0 * double(stats.steadyLost) / double(stats.ticks) : 0.0;
+    bool passed = !stuck;
+    if (steadyLossPct > options.maxSteadyLossPct) {
+        std::fprintf(stderr, "[soak] FAIL: %.3f%% of frames lost outside faults (limit %.3f%%)\n", steadyLossPct,
+                     options.maxSteadyLossPct);
+        passed = false;
+    }
+    if (stuck) std::fprintf(stderr, "[soak] FAIL: a fault was not recovered from\n");
+    if (passed) std::fprintf(stderr, "[soak] PASS\n");
+    return passed ? 0 : 1;
+}
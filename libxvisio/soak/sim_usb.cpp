@@ -0,0 +1,536 @@
+/**
+ * @file sim_usb.cpp
+ * @brief The libusb entry points libxvisio uses, backed by one simulated XR50
+ */
+
+#include "sim_usb.h"
+#include <libusb.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+struct libusb_context {
+    int unused = 0;
+};
+
+struct libusb_device {
+    int unused = 0;
+};
+
+struct libusb_device_handle {
+    uint64_t generation = 0;             // plug-in the handle was opened on; stale afterwards
+    std::array<uint8_t, 64> command{};  // last HID SET_REPORT, answered by the next GET_REPORT
+};
+
+namespace sim {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint8_t SLAM_ENDPOINT = 0x83;
+    constexpr int PACKET_SIZE = 63;
+    constexpr uint32_t FIRST_BOOT_TIMESTAMP_US = 4294000000u;  // long uptime: the counter wraps a second in
+    constexpr uint32_t REBOOT_TIMESTAMP_US = 5000;
+    constexpr uint64_t RECOVERED_STREAK = 100;  // frames in a row that count as streaming again
+    constexpr int16_t UNIT = 16383;  // quaternion fixed point
+    constexpr int32_t METRE = 16384;  // translation fixed point
+
+    struct Queued {
+        libusb_transfer* transfer;
+        Clock::time_point submitted;
+        bool cancelled = false;
+    };
+
+    using Completion = std::pair<libusb_transfer*, libusb_transfer_status>;
+
+    struct Simulator {
+        std::mutex mutex;
+        std::condition_variable changed;
+        Config config;
+        libusb_context* context = nullptr;
+        libusb_device device;
+        libusb_hotplug_callback_fn hotplug = nullptr;
+        void* hotplugUser = nullptr;
+        std::deque<Queued> queued;  // submission order
+        bool interrupted = false;
+
+        // Device
+        uint64_t generation = 1;
+        bool plugged = true;
+        Clock::time_point replugAt;
+        Clock::time_point bootedAt = Clock::now();
+        uint32_t bootTimestamp = FIRST_BOOT_TIMESTAMP_US;
+        bool streaming = false;
+        bool halted = false;
+        bool silent = false;
+        int refusals = 0;
+
+        // Frame ticks, from the first start-stream command on
+        bool ticking = false;
+        Clock::time_point epoch;
+        uint64_t tick = 0;
+
+        // Faults
+        bool requested = false;
+        Fault requestedFault = Fault::Stall;
+        int requestedRefusals = 0;
+        Fault current = Fault::Stall;
+        bool resolved = false;
+        Clock::time_point resolvedAt;
+        uint64_t lostAtInjection = 0;
+        uint64_t streak = 0;  // frames delivered in a row since the fault was resolved
+        Clock::time_point streakStart;
+        uint64_t lostAtStreak = 0;
+
+        Stats stats;
+
+        // Steady ticks of 1/rateHz; rounding never accumulates
+        [[nodiscard]] Clock::time_point due(uint64_t index) const {
+            return epoch + std::chrono::nanoseconds(int64_t(double(index) * 1e9 / config.rateHz));
+        }
+
+        [[nodiscard]] bool stale(const libusb_device_handle* handle) const {
+            return !plugged || handle->generation != generation;
+        }
+
+        void resolve(Clock::time_point now) {
+            if (stats.recovering && !resolved) {
+                resolved = true;
+                resolvedAt = now;
+            }
+        }
+
+        void apply(Clock::time_point now, std::vector<Completion>& done) {
+            requested = false;
+            current = requestedFault;
+            resolved = false;
+            streak = 0;
+            stats.recovering = true;
+            stats.injected[size_t(current)]++;
+            lostAtInjection = stats.lostTotal();
+            switch (current) {
+            case Fault::Wedge:
+                refusals = requestedRefusals;
+                [[fallthrough]];
+            case Fault::Stall:
+                halted = true;
+                resolve(now);
+                break;
+            case Fault::Timeout:
+                silent = true;
+                break;
+            case Fault::Unplug:
+                plugged = false;
+                generation++;
+                streaming = halted = silent = false;
+                refusals = 0;
+                replugAt = now + config.unplugFor;
+                for (const auto& q : queued) done.emplace_back(q.transfer, LIBUSB_TRANSFER_NO_DEVICE);
+                queued.clear();
+                break;
+            }
+        }
+
+        /// HID SET_REPORT / GET_REPORT on interface 3: acknowledge by echoing the command
+        int control(libusb_device_handle* handle, uint8_t requestType, uint8_t* data, uint16_t length) {
+            if (stale(handle)) return LIBUSB_ERROR_NO_DEVICE;
+            auto& command = handle->command;
+            if (!(requestType & LIBUSB_ENDPOINT_IN)) {
+                command.fill(0);
+                std::copy_n(data, std::min<size_t>(length, command.size()), command.begin());
+                if (command[1] == 0x19 && command[2] == 0x95) streaming = false;  // configure
+                if (command[1] == 0xa2 && command[2] == 0x33) startStream(Clock::now());
+                return length;
+            }
+            std::memset(data, 0, length);
+            data[0] = 0x01;
+            std::copy_n(command.begin() + 1, std::min<size_t>(length, command.size()) - 1, data + 1);
+            auto text = [&](size_t offset, const char* value) {
+                std::memcpy(data + offset, value, std::min<size_t>(std::strlen(value) + 1, length - offset));
+            };
+            if (command[1] == 0xfd && command[2] == 0x66) text(5, "XR50SIM00001");
+            if (command[1] == 0x1c && command[2] == 0x99) text(3, "sim-1.0");
+            if (command[1] == 0xde && command[2] == 0x62) data[4] = 0x07;  // edge, mixed, stereo
+            return length;
+        }
+
+        void startStream(Clock::time_point now) {
+            streaming = true;
+            if (ticking) return;
+            ticking = true;
+            epoch = now;
+            tick = 0;
+        }
+
+        /// Slow circle with a steady yaw, encoded like the firmware does
+        void fill(uint8_t* packet, Clock::time_point at) const {
+            const auto sinceBoot = std::chrono::duration_cast<std::chrono::microseconds>(at - bootedAt).count();
+            const uint32_t timestamp = bootTimestamp + uint32_t(sinceBoot);
+            const double t = double(sinceBoot) * 1e-6;
+            const int32_t translation[3] = {int32_t(std::cos(t / 2) * METRE), int32_t(std::sin(t / 2) * METRE),
+                                            METRE / 2};
+            const int16_t quaternion[4] = {int16_t(-std::cos(t / 8) * UNIT), 0, int16_t(std::sin(t / 8) * UNIT), 0};
+            std::memset(packet, 0, PACKET_SIZE);
+            packet[0] = 0x01;
+            packet[1] = 0xa2;
+            packet[2] = 0x33;
+            std::memcpy(packet + 3, &timestamp, sizeof(timestamp));
+            std::memcpy(packet + 7, translation, sizeof(translation));
+            std::memcpy(packet + 19, quaternion, sizeof(quaternion));
+        }
+
+        void recovered() {
+            auto& recovery = stats.recoveries[size_t(current)];
+            const auto us = uint64_t(std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(streakStart - resolvedAt).count(), 0));
+            recovery.count++;
+            recovery.totalUs += us;
+            recovery.maxUs = std::max(recovery.maxUs, us);
+            recovery.framesLost += lostAtStreak - lostAtInjection;
+            stats.recovering = false;
+        }
+
+        /// One frame tick: into the oldest queued EP 0x83 transfer, or lost
+        void emit(Clock::time_point at, Clock::time_point now, std::vector<Completion>& done) {
+            stats.ticks++;
+            Loss loss = Loss::NoTransfer;
+            if (!plugged) loss = Loss::Unplugged;
+            else if (!streaming) loss = Loss::NotStreaming;
+            else if (halted) loss = Loss::Halted;
+            else if (silent) loss = Loss::Silent;
+            else {
+                const auto slot = std::find_if(queued.begin(), queued.end(), [](const Queued& q) {
+                    return !q.cancelled && q.transfer->endpoint == SLAM_ENDPOINT;
+                });
+                if (slot != queued.end()) {
+                    fill(slot->transfer->buffer, at);
+                    slot->transfer->actual_length = PACKET_SIZE;
+                    done.emplace_back(slot->transfer, LIBUSB_TRANSFER_COMPLETED);
+                    queued.erase(slot);
+                    stats.delivered++;
+                    if (stats.recovering && resolved && ++streak == 1) {
+                        streakStart = now;
+                        lostAtStreak = stats.lostTotal();
+                    }
+                    if (stats.recovering && streak >= RECOVERED_STREAK) recovered();
+                    return;
+                }
+            }
+            streak = 0;
+            stats.lost[size_t(loss)]++;
+            if (!stats.recovering) stats.steadyLost++;
+        }
+
+        /// Everything due by now; returns when the next thing falls due
+        Clock::time_point step(Clock::time_point now, std::vector<Completion>& done, bool& arrival) {
+            if (requested) apply(now, done);
+            if (!plugged && now >= replugAt) {
+                plugged = true;
+                arrival = true;
+                bootedAt = now;
+                bootTimestamp = REBOOT_TIMESTAMP_US;
+                resolve(now);
+            }
+
+            auto next = Clock::time_point::max();
+            for (auto q = queued.begin(); q != queued.end();) {
+                auto* transfer = q->transfer;
+                std::optional<libusb_transfer_status> status;
+                if (q->cancelled) {
+                    status = LIBUSB_TRANSFER_CANCELLED;
+                } else if (transfer->type == LIBUSB_TRANSFER_TYPE_CONTROL) {
+                    const auto* setup = libusb_control_transfer_get_setup(transfer);
+                    const int length = control(transfer->dev_handle, setup->bmRequestType,
+                                               libusb_control_transfer_get_data(transfer), setup->wLength);
+                    transfer->actual_length = std::max(length, 0);
+                    status = length < 0 ? LIBUSB_TRANSFER_NO_DEVICE : LIBUSB_TRANSFER_COMPLETED;
+                } else if (halted) {
+                    status = LIBUSB_TRANSFER_STALL;
+                } else if (silent && transfer->timeout > 0) {
+                    const auto expires = q->submitted + std::chrono::milliseconds(transfer->timeout);
+                    if (now >= expires) {
+                        status = LIBUSB_TRANSFER_TIMED_OUT;
+                        silent = false;  // answering again, the host has to notice
+                        resolve(now);
+                    } else {
+                        next = std::min(next, expires);
+                    }
+                }
+                if (status) {
+                    done.emplace_back(transfer, *status);
+                    q = queued.erase(q);
+                } else {
+                    ++q;
+                }
+            }
+
+            if (ticking) {
+                for (; due(tick) <= now; tick++) emit(due(tick), now, done);
+                next = std::min(next, due(tick));
+            }
+            if (!plugged) next = std::min(next, replugAt);
+            return next;
+        }
+
+        int handleEvents(const timeval* tv, const int* completed) {
+            const auto deadline = Clock::now() + (tv ? std::chrono::seconds(tv->tv_sec) +
+                                                  std::chrono::microseconds(tv->tv_usec)
+                                                     : std::chrono::microseconds(std::chrono::seconds(60)));
+            std::unique_lock lock(mutex);
+            while (true) {
+                if (interrupted) {
+                    interrupted = false;
+                    return LIBUSB_SUCCESS;
+                }
+                if (completed && *completed) return LIBUSB_SUCCESS;
+
+                std::vector<Completion> done;
+                bool arrival = false;
+                const auto next = step(Clock::now(), done, arrival);
+                if (!done.empty() || arrival) {
+                    // Callbacks resubmit and cancel: never under the lock
+                    lock.unlock();
+                    if (arrival && hotplug) {
+                        hotplug(context, &device, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, hotplugUser);
+                    }
+                    for (auto& [transfer, status] : done) {
+                        transfer->status = status;
+                        transfer->callback(transfer);
+                    }
+                    return LIBUSB_SUCCESS;
+                }
+                if (Clock::now() >= deadline) return LIBUSB_SUCCESS;
+                changed.wait_until(lock, std::min(next, deadline));
+            }
+        }
+    };
+
+    Simulator& simulator() {
+        static Simulator instance;
+        return instance;
+    }
+}
+
+void configure(const Config& config) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    s.config = config;
+}
+
+bool inject(Fault fault, int refusals) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    if (s.requested || s.stats.recovering) return false;
+    s.requested = true;
+    s.requestedFault = fault;
+    s.requestedRefusals = refusals;
+    s.changed.notify_all();
+    return true;
+}
+
+Stats stats() {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    return s.stats;
+}
+
+const char* name(Fault fault) {
+    constexpr const char* names[] = {"stall", "wedge", "timeout", "unplug"};
+    return names[size_t(fault)];
+}
+
+const char* name(Loss loss) {
+    constexpr const char* names[] = {"no transfer", "halted", "silent", "unplugged", "not streaming"};
+    return names[size_t(loss)];
+}
+
+} // namespace sim
+
+using sim::Clock;
+using sim::SLAM_ENDPOINT;
+using sim::simulator;
+
+extern "C" {
+
+int libusb_init(libusb_context** context) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    s.context = new libusb_context;
+    *context = s.context;
+    return LIBUSB_SUCCESS;
+}
+
+void libusb_exit(libusb_context* context) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    if (context == s.context) s.context = nullptr;
+    delete context;
+}
+
+ssize_t libusb_get_device_list(libusb_context*, libusb_device*** list) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    *list = static_cast<libusb_device**>(std::calloc(2, sizeof(libusb_device*)));
+    if (!s.plugged) return 0;
+    (*list)[0] = &s.device;
+    return 1;
+}
+
+void libusb_free_device_list(libusb_device** list, int) { std::free(list); }
+libusb_device* libusb_ref_device(libusb_device* device) { return device; }
+void libusb_unref_device(libusb_device*) {}
+uint8_t libusb_get_bus_number(libusb_device*) { return 1; }
+uint8_t libusb_get_device_address(libusb_device*) { return 2; }
+
+int libusb_get_port_numbers(libusb_device*, uint8_t* ports, int length) {
+    if (length < 1) return LIBUSB_ERROR_OVERFLOW;
+    ports[0] = 1;
+    return 1;
+}
+
+int libusb_get_device_descriptor(libusb_device*, libusb_device_descriptor* descriptor) {
+    std::memset(descriptor, 0, sizeof(*descriptor));
+    descriptor->idVendor = 0x040e;
+    descriptor->idProduct = 0xf408;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_open(libusb_device*, libusb_device_handle** handle) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    if (!s.plugged) return LIBUSB_ERROR_NO_DEVICE;
+    *handle = new libusb_device_handle;
+    (*handle)->generation = s.generation;
+    return LIBUSB_SUCCESS;
+}
+
+void libusb_close(libusb_device_handle* handle) { delete handle; }
+
+int libusb_kernel_driver_active(libusb_device_handle*, int) { return 0; }
+int libusb_detach_kernel_driver(libusb_device_handle*, int) { return LIBUSB_SUCCESS; }
+
+int libusb_claim_interface(libusb_device_handle* handle, int) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    return s.stale(handle) ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_SUCCESS;
+}
+
+int libusb_release_interface(libusb_device_handle* handle, int) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    return s.stale(handle) ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_SUCCESS;
+}
+
+int libusb_clear_halt(libusb_device_handle* handle, unsigned char endpoint) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    if (s.stale(handle)) return LIBUSB_ERROR_NO_DEVICE;
+    if (endpoint != SLAM_ENDPOINT) return LIBUSB_ERROR_NOT_FOUND;
+    s.halted = false;
+    s.stats.clearHalts++;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_control_transfer(libusb_device_handle* handle, uint8_t requestType, uint8_t, uint16_t, uint16_t,
+                            unsigned char* data, uint16_t length, unsigned int) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    return s.control(handle, requestType, data, length);
+}
+
+libusb_transfer* libusb_alloc_transfer(int isoPackets) {
+    const size_t size = sizeof(libusb_transfer) + size_t(isoPackets) * sizeof(libusb_iso_packet_descriptor);
+    return static_cast<libusb_transfer*>(std::calloc(1, size));
+}
+
+void libusb_free_transfer(libusb_transfer* transfer) { std::free(transfer); }
+
+int libusb_submit_transfer(libusb_transfer* transfer) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    if (s.stale(transfer->dev_handle)) return LIBUSB_ERROR_NO_DEVICE;
+    if (transfer->endpoint == SLAM_ENDPOINT && !s.halted && s.refusals > 0) {
+        s.refusals--;
+        s.stats.refusedSubmits++;
+        return LIBUSB_ERROR_IO;
+    }
+    s.queued.push_back({transfer, Clock::now()});
+    s.changed.notify_all();
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_cancel_transfer(libusb_transfer* transfer) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    const auto q = std::find_if(s.queued.begin(), s.queued.end(),
+                                [transfer](const auto& queued) { return queued.transfer == transfer; });
+    if (q == s.queued.end() || q->cancelled) return LIBUSB_ERROR_NOT_FOUND;
+    q->cancelled = true;
+    s.changed.notify_all();
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_handle_events_timeout_completed(libusb_context*, timeval* tv, int* completed) {
+    return simulator().handleEvents(tv, completed);
+}
+
+int libusb_handle_events_timeout(libusb_context*, timeval* tv) { return simulator().handleEvents(tv, nullptr); }
+int libusb_handle_events(libusb_context*) { return simulator().handleEvents(nullptr, nullptr); }
+int libusb_handle_events_completed(libusb_context*, int* completed) {
+    return simulator().handleEvents(nullptr, completed);
+}
+
+void libusb_interrupt_event_handler(libusb_context*) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    s.interrupted = true;
+    s.changed.notify_all();
+}
+
+// No pollfds: the event loop waits inside libusb_handle_events, which wakes on the simulator's own clock
+const libusb_pollfd** libusb_get_pollfds(libusb_context*) {
+    return static_cast<const libusb_pollfd**>(std::calloc(1, sizeof(libusb_pollfd*)));
+}
+
+void libusb_free_pollfds(const libusb_pollfd** pollfds) { std::free(pollfds); }
+void libusb_set_pollfd_notifiers(libusb_context*, libusb_pollfd_added_cb, libusb_pollfd_removed_cb, void*) {}
+int libusb_pollfds_handle_timeouts(libusb_context*) { return 1; }
+int libusb_get_next_timeout(libusb_context*, timeval*) { return 0; }
+
+int libusb_hotplug_register_callback(libusb_context*, int, int, int, int, int, libusb_hotplug_callback_fn callback,
+                                     void* user, libusb_hotplug_callback_handle* handle) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    s.hotplug = callback;
+    s.hotplugUser = user;
+    if (handle) *handle = 1;
+    return LIBUSB_SUCCESS;
+}
+
+void libusb_hotplug_deregister_callback(libusb_context*, libusb_hotplug_callback_handle) {
+    auto& s = simulator();
+    std::lock_guard lock(s.mutex);
+    s.hotplug = nullptr;
+}
+
+const char* libusb_strerror(int code) {
+    switch (code) {
+    case LIBUSB_SUCCESS: return "Success";
+    case LIBUSB_ERROR_IO: return "Input/Output Error";
+    case LIBUSB_ERROR_NO_DEVICE: return "No such device (it may have been disconnected)";
+    case LIBUSB_ERROR_NOT_FOUND: return "Entity not found";
+    case LIBUSB_ERROR_TIMEOUT: return "Operation timed out";
+    case LIBUSB_ERROR_PIPE: return "Pipe error";
+    case LIBUSB_ERROR_INTERRUPTED: return "System call interrupted (perhaps due to signal)";
+    default: return "Other error";
+    }
+}
+
+} // extern "C"
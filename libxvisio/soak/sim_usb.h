@@ -0,0 +1,92 @@
+/**
+ * @file sim_usb.h
+ * @brief Control side of the simulated libusb the soak test links instead of the real one
+ */
+
+#ifndef XVISIO_SIM_USB_H
+#define XVISIO_SIM_USB_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One simulated XR50 behind the libusb calls libxvisio makes.
+ *
+ * It answers the HID identify/configure/start-stream commands and, once the
+ * stream is started, produces a 63-byte 01 A2 33 packet every 1/rateHz on
+ * EP 0x83, handed to the oldest queued interrupt transfer. A frame tick that
+ * finds no queued transfer (or a halted, silent or missing device) is lost,
+ * as it would be on the wire. Everything runs inside libusb_handle_events on
+ * the caller's thread, like a real backend completing transfers.
+ */
+namespace sim {
+
+enum class Fault : uint8_t {
+    Stall = 0,  ///< EP 0x83 halts: transfers complete as STALL until libusb_clear_halt
+    Wedge,      ///< Stall, and the endpoint also refuses the next few submissions (drives the retry limit)
+    Timeout,    ///< EP 0x83 goes silent until the oldest transfer's own timeout expires (TIMED_OUT)
+    Unplug,     ///< NO_DEVICE everywhere; the device re-enumerates with a fresh clock after unplugFor
+};
+inline constexpr size_t FAULT_KINDS = 4;
+
+/// Why a frame tick did not reach the host (Stats::lost index)
+enum class Loss : uint8_t {
+    NoTransfer = 0,  ///< nothing queued on EP 0x83: host late or recovering
+    Halted,
+    Silent,
+    Unplugged,
+    NotStreaming,    ///< plugged in but not (yet) told to start the stream
+};
+inline constexpr size_t LOSS_KINDS = 5;
+
+struct Config {
+    double rateHz = 1000.0;
+    std::chrono::milliseconds unplugFor{500};
+};
+
+/// Time from a fault being resolvable (injected; timed out; replugged) until frames flow again:
+/// to the first of 100 delivered in a row, so the stragglers before the host resets do not count
+struct Recovery {
+    uint64_t count = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+    uint64_t framesLost = 0;  ///< ticks lost between injection and the end of the recovery
+
+    [[nodiscard]] double meanMs() const { return count ? totalUs / 1000.0 / double(count) : 0.0; }
+};
+
+struct Stats {
+    uint64_t ticks = 0;      ///< frame ticks since the stream was first started
+    uint64_t delivered = 0;  ///< ticks completed into an EP 0x83 transfer
+    std::array<uint64_t, LOSS_KINDS> lost{};
+    uint64_t steadyLost = 0;  ///< of those, lost with no fault open: the host falling behind
+    std::array<uint64_t, FAULT_KINDS> injected{};
+    std::array<Recovery, FAULT_KINDS> recoveries{};
+    uint64_t clearHalts = 0;
+    uint64_t refusedSubmits = 0;
+    bool recovering = false;  ///< the last fault has not been recovered from yet
+
+    [[nodiscard]] uint64_t lostTotal() const {
+        uint64_t total = 0;
+        for (const uint64_t count : lost) total += count;
+        return total;
+    }
+};
+
+/// Before libusb_init
+void configure(const Config& config);
+
+/// Applied at the next event handling pass. False (and ignored) while a previous fault has not
+/// been recovered from. refusals: submissions the endpoint rejects after a Wedge.
+bool inject(Fault fault, int refusals = 0);
+
+[[nodiscard]] Stats stats();
+
+[[nodiscard]] const char* name(Fault fault);
+[[nodiscard]] const char* name(Loss loss);
+
+} // namespace sim
+
+#endif // XVISIO_SIM_USB_H
@@ -4,83 +4,189 @@
  */
 
 #include "device.h"
+#include "event_loop.h"
 #include "hid.h"
 #include "slam.h"
+#include "logging.h"
 #include <array>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
 
 namespace xv {
 
-Device::Device(libusb_device* libusbDevice, libusb_context* context) 
-    : libusbDevice(libusbDevice), libusbContext(context) {
-    
-    int res = libusb_open(libusbDevice, &handle);
-    if (res != 0) {
-        switch (res) {
-            case LIBUSB_ERROR_ACCESS:
-                throw std::runtime_error("Access denied. Run with sudo on macOS.");
-            case LIBUSB_ERROR_NO_DEVICE:
-                throw std::runtime_error("Device disconnected.");
-            default:
-                throw std::runtime_error(std::string("USB error: ") + libusb_strerror(res));
+namespace {
+    constexpr int HID_INTERFACE = 3;
+
+    /// Open the device and claim the HID interface
+    libusb_device_handle* openInterface(libusb_device* libusbDevice) {
+        libusb_device_handle* handle = nullptr;
+        int res = libusb_open(libusbDevice, &handle);
+        if (res != 0) {
+            switch (res) {
+                case LIBUSB_ERROR_ACCESS:
+                    throw std::runtime_error("Access denied. Run with sudo on macOS.");
+                case LIBUSB_ERROR_NO_DEVICE:
+                    throw std::runtime_error("Device disconnected.");
+                default:
+                    throw std::runtime_error(std::string("USB error: ") + libusb_strerror(res));
+            }
         }
+
+        // Detach kernel driver if active
+        if (libusb_kernel_driver_active(handle, HID_INTERFACE) == 1) {
+            XV_DEBUG("Detaching kernel driver from interface 3");
+            libusb_detach_kernel_driver(handle, HID_INTERFACE);
+        }
+
+        res = libusb_claim_interface(handle, HID_INTERFACE);
+        if (res != 0) {
+            libusb_close(handle);
+            throw std::runtime_error(std::string("Cannot claim interface: ") + libusb_strerror(res));
+        }
+        return handle;
     }
-    
-    hid = std::make_unique<HID>(handle);
-    
-    // Detach kernel driver if active
-    if (libusb_kernel_driver_active(handle, 3) == 1) {
-        libusb_detach_kernel_driver(handle, 3);
-    }
-    
-    res = libusb_claim_interface(handle, 3);
-    if (res != 0) {
-        throw std::runtime_error(std::string("Cannot claim interface: ") + libusb_strerror(res));
+
+    void closeInterface(libusb_device_handle* handle) {
+        libusb_release_interface(handle, HID_INTERFACE); // Ignoring errors is fine here
+        libusb_close(handle);
     }
-    
-    // Read device UUID
-    std::array<uint8_t, 4> uuidCmd = {0xfd, 0x66, 0x00, 0x02};
-    std::array<uint8_t, 58> uuidResult = {0};
-    if (hid->executeTransaction(uuidCmd, uuidResult)) {
-        uuid = std::string(reinterpret_cast<const char*>(uuidResult.data()));
-    } else {
-        throw std::runtime_error("Failed to read device UUID");
+
+    /// HID channel that owns the handle: the interface is closed after its last user is done
+    std::shared_ptr<HID> openChannel(libusb_device_handle* handle, EventLoop* loop) {
+        return {new HID(handle, loop), [handle](HID* hid) {
+            delete hid;  // no command may be in flight on a closed handle
+            closeInterface(handle);
+        }};
     }
-    
-    // Read firmware version
-    std::array<uint8_t, 2> versionCmd = {0x1c, 0x99};
-    std::array<uint8_t, 60> versionResult = {0};
-    if (hid->executeTransaction(versionCmd, versionResult)) {
-        version = std::string(reinterpret_cast<const char*>(versionResult.data()));
-    } else {
-        throw std::runtime_error("Failed to read firmware version");
+
+    const std::vector<uint8_t> UUID_COMMAND = {0xfd, 0x66, 0x00, 0x02};
+    const std::vector<uint8_t> VERSION_COMMAND = {0x1c, 0x99};
+    const std::vector<uint8_t> FEATURES_COMMAND = {0xde, 0x62, 0x01};
+
+    /// NUL-terminated string reply, or throw naming what was being read
+    std::string replyString(const HidResult& reply, const char* what) {
+        if (reply.error != LIBUSB_SUCCESS) {
+            throw std::runtime_error(std::string("libusb error during HID transaction: ") + libusb_strerror(reply.error));
+        }
+        if (!reply.acknowledged) throw std::runtime_error(std::string("Failed to read ") + what);
+        const auto* text = reinterpret_cast<const char*>(reply.payload.data());
+        return std::string(text, strnlen(text, reply.size));
     }
-    
-    // Read device features
-    std::array<uint8_t, 3> featuresCmd = {0xde, 0x62, 0x01};
-    std::array<uint8_t, 59> featuresResult = {0};
-    if (hid->executeTransaction(featuresCmd, featuresResult)) {
-        featuresBitmap = featuresResult[0] | (featuresResult[1] << 8) | 
-                         (featuresResult[2] << 16) | (featuresResult[3] << 24);
-    } else {
-        throw std::runtime_error("Failed to read device features");
+}
+
+Device::Device(libusb_device* libusbDevice, EventLoop* eventLoop, uint32_t timeoutMs)
+    : libusbDevice(libusbDevice), libusbContext(eventLoop->getContext()), eventLoop(eventLoop) {
+    using Clock = std::chrono::steady_clock;
+    const auto began = Clock::now();
+    handle = openInterface(libusbDevice);
+    hid = openChannel(handle, eventLoop);
+    const auto opened = Clock::now();
+    openTiming.open = std::chrono::duration_cast<std::chrono::microseconds>(opened - began);
+
+    // UUID, firmware version and features, queued back to back
+    auto replies = hid->submitBatch({UUID_COMMAND, VERSION_COMMAND, FEATURES_COMMAND}, timeoutMs);
+    try {
+        uuid = replyString(replies[0].get(), "device UUID");
+        version = replyString(replies[1].get(), "firmware version");
+        const HidResult features = replies[2].get();
+        replyString(features, "device features");
+        const auto& bytes = features.payload;
+        featuresBitmap = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
+    } catch (...) {
+        // The destructor does not run for a half-built Device
+        hid.reset();
+        throw;
     }
+    openTiming.identify = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - opened);
+    XV_DEBUG("Opened {} (firmware {}, features bitmap {})", uuid, version, featuresBitmap);
     
-    slam = std::make_shared<Slam>(this, context, handle);
+    slam = std::make_shared<Slam>(this, eventLoop, handle);
+    // Our own reference: the device stays readable (bus, address) while detached
+    libusb_ref_device(libusbDevice);
 }
 
 Device::~Device() {
     // Safe cleanup — device may already be disconnected
-    if (handle) {
-        libusb_release_interface(handle, 3); // Ignoring errors is fine here
-        libusb_close(handle);
+    slam.reset();
+    std::lock_guard lock(channelMutex);
+    hid.reset();
+    handle = nullptr;
+    libusb_unref_device(libusbDevice);
+}
+
+std::shared_ptr<HID> Device::channel() const {
+    std::lock_guard lock(channelMutex);
+    if (!hid) throw std::runtime_error("Device disconnected.");
+    return hid;
+}
+
+void Device::detach() {
+    std::shared_ptr<HID> released;
+    {
+        std::lock_guard lock(channelMutex);
+        if (!handle) return;
+        connected = false;
+        released = std::move(hid);
         handle = nullptr;
     }
+    // Closed here, or by a start()/resume() still in a command once that command returns
+}
+
+bool Device::reattach(libusb_device* candidate) {
+    if (connected) return false;
+
+    libusb_device_handle* candidateHandle = nullptr;
+    try {
+        candidateHandle = openInterface(candidate);
+        bool same;
+        {
+            HID candidateHid(candidateHandle, eventLoop);
+            same = replyString(candidateHid.submit(UUID_COMMAND).get(), "device UUID") == uuid;
+        }
+        if (!same) {
+            closeInterface(candidateHandle);
+            return false;
+        }
+    } catch (const std::runtime_error& e) {
+        XV_DEBUG("Reattach probe: {}", e.what());
+        if (candidateHandle) closeInterface(candidateHandle);
+        return false;
+    }
+
+    {
+        std::lock_guard lock(channelMutex);
+        libusb_unref_device(libusbDevice);
+        libusbDevice = libusb_ref_device(candidate);
+        handle = candidateHandle;
+        hid = openChannel(handle, eventLoop);
+        connected = true;
+    }
+    XV_INFO("{} is back, resuming", uuid);
+    slam->resume(handle);
+    return true;
 }
 
 std::string& Device::getUUID() { return uuid; }
 std::string& Device::getVersion() { return version; }
 
+std::string Device::getBusId() const {
+    std::array<uint8_t, 7> ports{};  // USB 3 allows at most 7 tiers
+    std::lock_guard lock(channelMutex);
+    const int depth = libusb_get_port_numbers(libusbDevice, ports.data(), int(ports.size()));
+    std::string busId = std::to_string(libusb_get_bus_number(libusbDevice));
+    for (int i = 0; i < depth; ++i) {
+        busId += i == 0 ? '-' : '.';
+        busId += std::to_string(ports[i]);
+    }
+    return busId;
+}
+
+uint8_t Device::getAddress() const {
+    std::lock_guard lock(channelMutex);
+    return libusb_get_device_address(libusbDevice);
+}
+
 bool Device::getEdgeModeSupport() const { return featuresBitmap & (1 << 0); }
 bool Device::get_mixed_mode_support() const { return featuresBitmap & (1 << 1); }
 bool Device::getStereoSupport() const { return featuresBitmap & (1 << 2); }
@@ -92,17 +198,37 @@ bool Device::getEyeTrackingSupport() const { return featuresBitmap & (1 << 10);
 bool Device::getFaceIDSupport() const { return featuresBitmap & (1 << 12); }
 
 void Device::configureDevice(bool edge6dof, uint8_t uvcMode, bool embeddedAlgo) const {
+    XV_DEBUG("Configure: edge6dof={} uvcMode={} embeddedAlgo={}", edge6dof, uvcMode, embeddedAlgo);
     std::array<uint8_t, 5> cmd = {0x19, 0x95, edge6dof, uvcMode, embeddedAlgo};
     std::array<uint8_t, 57> result = {0};
-    hid->executeTransaction(cmd, result);
+    channel()->executeTransaction(cmd, result);
 }
 
 void Device::startEdgeStream(uint8_t edgeMode, bool rotationEnabled, bool flipped) const {
+    XV_DEBUG("Start edge stream: edgeMode={} rotation={} flipped={}", edgeMode, rotationEnabled, flipped);
     std::array<uint8_t, 5> cmd = {0xa2, 0x33, edgeMode, rotationEnabled, flipped};
     std::array<uint8_t, 57> result = {0};
-    hid->executeTransaction(cmd, result);
+    channel()->executeTransaction(cmd, result);
 }
 
+std::future<HidResult> Device::sendCommand(std::span<const uint8_t> command, uint32_t timeoutMs) const {
+    return channel()->submit(command, timeoutMs);
+}
+
+bool Device::probe(uint32_t timeoutMs) const {
+    // Firmware version: read-only and answered by every firmware
+    std::array<uint8_t, 2> cmd = {0x1c, 0x99};
+    std::array<uint8_t, 60> result = {0};
+    try {
+        return channel()->executeTransaction(cmd, result, timeoutMs);
+    } catch (const std::runtime_error&) {
+        return false;  // busy or still reconfiguring: the control transfer timed out
+    }
+}
+
+const ImuCalibration& Device::getImuCalibration() const { return imuCalibration; }
+void Device::setImuCalibration(const ImuCalibration& calibration) { imuCalibration = calibration; }
+
 std::shared_ptr<Slam> Device::getSlam() const { return slam; }
 
 } // namespace xv
@@ -0,0 +1,268 @@
+/**
+ * @file event_loop.cpp
+ * @brief libusb event thread with deadline-ordered tasks
+ */
+
+#include "event_loop.h"
+#include <algorithm>
+#include <future>
+#include "logging.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/event.h>
+#include <unistd.h>
+#endif
+
+namespace xv {
+
+namespace {
+    // Upper bound on a single wait; libusb's own timeouts (if any) still fire on time
+    constexpr auto MAX_WAIT = std::chrono::seconds(1);
+}
+
+EventLoop::EventLoop(libusb_context* context) : context(context) {
+    if (openPoller()) XV_DEBUG("USB event loop blocks on libusb pollfds");
+    else XV_DEBUG("USB event loop waits inside libusb");
+    thread = std::thread(&EventLoop::run, this);
+}
+
+EventLoop::~EventLoop() {
+    running = false;
+    wake();
+    thread.join();
+    closePoller();
+}
+
+bool EventLoop::inLoopThread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+void EventLoop::post(Task task, Clock::duration delay) {
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back({Clock::now() + delay, posted++, std::move(task)});
+    }
+    // The loop recomputes its deadline; a wake-up raised before it waits is not lost
+    if (!inLoopThread()) wake();
+}
+
+void EventLoop::runSync(const Task& task) {
+    if (inLoopThread()) return task();
+    std::promise<void> done;
+    post([&] {
+        task();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+void EventLoop::setThreadPolicy(const ThreadPolicy& policy) {
+    std::exception_ptr error;
+    runSync([&] {
+        try {
+            applyThreadPolicy(policy);
+        } catch (...) {
+            error = std::current_exception();
+        }
+    });
+    if (error) std::rethrow_exception(error);
+    XV_INFO("USB event thread: priority {}, {} CPU(s), memory {}", policy.realtimePriority, policy.cpus.size(),
+            policy.lockMemory ? "locked" : "pageable");
+}
+
+EventLoop::Clock::duration EventLoop::untilNextTask() {
+    std::lock_guard lock(mutex);
+    auto wait = Clock::duration(MAX_WAIT);
+    const auto now = Clock::now();
+    for (const auto& timed : tasks) {
+        wait = std::min(wait, std::max(timed.due - now, Clock::duration::zero()));
+    }
+    return wait;
+}
+
+void EventLoop::runDue() {
+    std::vector<Timed> due;
+    {
+        std::lock_guard lock(mutex);
+        const auto now = Clock::now();
+        const auto split = std::stable_partition(tasks.begin(), tasks.end(),
+                                                 [now](const Timed& t) { return t.due > now; });
+        std::move(split, tasks.end(), std::back_inserter(due));
+        tasks.erase(split, tasks.end());
+    }
+    std::sort(due.begin(), due.end(), [](const Timed& a, const Timed& b) {
+        return a.due != b.due ? a.due < b.due : a.order < b.order;
+    });
+    for (auto& timed : due) timed.task();
+}
+
+void EventLoop::run() {
+    while (running) {
+        if (pollerFd >= 0) {
+            waitPoller(untilNextTask());
+        } else {
+            const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(untilNextTask()).count();
+            struct timeval tv = {static_cast<long>(wait / 1000000), static_cast<long>(wait % 1000000)};
+            libusb_handle_events_timeout_completed(context, &tv, nullptr);
+        }
+        runDue();
+    }
+    runDue();  // Tasks posted during shutdown (e.g. a Slam teardown) still run
+}
+
+void EventLoop::wake() {
+    if (pollerFd < 0) return libusb_interrupt_event_handler(context);
+#if defined(__linux__)
+    const uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(wakeWrite, &one, sizeof(one));
+#elif defined(__APPLE__)
+    const char one = 1;
+    [[maybe_unused]] auto written = ::write(wakeWrite, &one, sizeof(one));  // a full pipe is already awake
+#endif
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+
+bool EventLoop::openPoller() {
+    const libusb_pollfd** fds = libusb_get_pollfds(context);
+    // No fds means libusb cannot be waited on from outside (e.g. Windows backends)
+    if (!fds || !fds[0]) {
+        if (fds) libusb_free_pollfds(fds);
+        return false;
+    }
+
+#if defined(__linux__)
+    pollerFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeRead = wakeWrite = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    bool ready = pollerFd >= 0 && wakeRead >= 0;
+    if (ready) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wakeRead;
+        ready = epoll_ctl(pollerFd, EPOLL_CTL_ADD, wakeRead, &event) == 0;
+    }
+#else
+    pollerFd = kqueue();
+    int pipeFds[2] = {-1, -1};
+    bool ready = pollerFd >= 0 && pipe(pipeFds) == 0;
+    wakeRead = pipeFds[0];
+    wakeWrite = pipeFds[1];
+    if (ready) {
+        for (int fd : pipeFds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        struct kevent event;
+        EV_SET(&event, wakeRead, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+        ready = kevent(pollerFd, &event, 1, nullptr, 0, nullptr) == 0;
+    }
+#endif
+    if (!ready) {
+        libusb_free_pollfds(fds);
+        closePoller();
+        return false;
+    }
+
+    for (const libusb_pollfd** fd = fds; *fd; ++fd) pollfdAdded((*fd)->fd, (*fd)->events, this);
+    libusb_free_pollfds(fds);
+    // Device fds come and go as handles open and close, from whichever thread does it
+    libusb_set_pollfd_notifiers(context, &EventLoop::pollfdAdded, &EventLoop::pollfdRemoved, this);
+    return true;
+}
+
+void EventLoop::closePoller() {
+    if (pollerFd >= 0) libusb_set_pollfd_notifiers(context, nullptr, nullptr, nullptr);
+    if (wakeWrite >= 0 && wakeWrite != wakeRead) ::close(wakeWrite);
+    if (wakeRead >= 0) ::close(wakeRead);
+    if (pollerFd >= 0) ::close(pollerFd);
+    pollerFd = wakeRead = wakeWrite = -1;
+}
+
+void EventLoop::pollfdAdded(int fd, short events, void* user) {
+    auto* self = static_cast<EventLoop*>(user);
+#if defined(__linux__)
+    epoll_event event{};
+    event.events = ((events & POLLIN) ? uint32_t(EPOLLIN) : 0u) | ((events & POLLOUT) ? uint32_t(EPOLLOUT) : 0u);
+    event.data.fd = fd;
+    if (epoll_ctl(self->pollerFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        epoll_ctl(self->pollerFd, EPOLL_CTL_MOD, fd, &event);
+    }
+#else
+    struct kevent changes[2];
+    int count = 0;
+    if (events & POLLIN) EV_SET(&changes[count++], fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    if (events & POLLOUT) EV_SET(&changes[count++], fd, EVFILT_WRITE, EV_ADD, 0, 0, nullptr);
+    kevent(self->pollerFd, changes, count, nullptr, 0, nullptr);
+#endif
+}
+
+void EventLoop::pollfdRemoved(int fd, void* user) {
+    auto* self = static_cast<EventLoop*>(user);
+#if defined(__linux__)
+    epoll_ctl(self->pollerFd, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    // Deleting a filter that was never added only fails, so remove both
+    struct kevent changes[2];
+    EV_SET(&changes[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    EV_SET(&changes[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    for (auto& change : changes) kevent(self->pollerFd, &change, 1, nullptr, 0, nullptr);
+#endif
+}
+
+void EventLoop::waitPoller(Clock::duration wait) {
+    // Backends without timerfd leave transfer timeouts to us
+    if (!libusb_pollfds_handle_timeouts(context)) {
+        struct timeval next;
+        if (libusb_get_next_timeout(context, &next) == 1) {
+            wait = std::min(wait, Clock::duration(std::chrono::seconds(next.tv_sec) +
+                                                  std::chrono::microseconds(next.tv_usec)));
+        }
+    }
+
+    constexpr int MAX_EVENTS = 16;
+#if defined(__linux__)
+    // Round up so a deadline is never woken for early and spun on
+    const auto timeoutMs = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+    epoll_event events[MAX_EVENTS];
+    const int ready = epoll_wait(pollerFd, events, MAX_EVENTS, static_cast<int>(timeoutMs));
+    for (int i = 0; i < ready; ++i) {
+        if (events[i].data.fd != wakeRead) continue;
+        uint64_t count;
+        [[maybe_unused]] auto drained = ::read(wakeRead, &count, sizeof(count));
+    }
+#else
+    const auto timeoutNs = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+    const struct timespec timeout = {static_cast<time_t>(timeoutNs / 1000000000),
+                                     static_cast<long>(timeoutNs % 1000000000)};
+    struct kevent events[MAX_EVENTS];
+    const int ready = kevent(pollerFd, nullptr, 0, events, MAX_EVENTS, &timeout);
+    for (int i = 0; i < ready; ++i) {
+        if (static_cast<int>(events[i].ident) != wakeRead) continue;
+        char buffer[64];
+        while (::read(wakeRead, buffer, sizeof(buffer)) > 0) {}
+    }
+#endif
+
+    // Completes whatever became ready (and expired timeouts) without blocking
+    struct timeval zero = {0, 0};
+    libusb_handle_events_timeout_completed(context, &zero, nullptr);
+}
+
+#else
+
+bool EventLoop::openPoller() { return false; }
+void EventLoop::closePoller() {}
+void EventLoop::pollfdAdded(int, short, void*) {}
+void EventLoop::pollfdRemoved(int, void*) {}
+void EventLoop::waitPoller(Clock::duration) {}
+
+#endif
+
+} // namespace xv
@@ -3,10 +3,249 @@
 //
 
 #include "hid.h"
+#include "event_loop.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 
 namespace xv {
-    HID::HID(libusb_device_handle* handle) : handle(handle) {
+    namespace {
+        constexpr uint8_t REQUEST_TYPE =
+                LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE; // NOLINT(*-suspicious-enum-usage)
+
+        int transferError(libusb_transfer_status status) {
+            switch (status) {
+                case LIBUSB_TRANSFER_TIMED_OUT: return LIBUSB_ERROR_TIMEOUT;
+                case LIBUSB_TRANSFER_CANCELLED: return LIBUSB_ERROR_INTERRUPTED;
+                case LIBUSB_TRANSFER_STALL: return LIBUSB_ERROR_PIPE;
+                case LIBUSB_TRANSFER_NO_DEVICE: return LIBUSB_ERROR_NO_DEVICE;
+                case LIBUSB_TRANSFER_OVERFLOW: return LIBUSB_ERROR_OVERFLOW;
+                default: return LIBUSB_ERROR_IO;
+            }
+        }
+    }
+
+    /// Everything a completion touches. The running command holds a reference, so a
+    /// transfer that outlives its HID completes into valid memory and frees it.
+    struct HID::Channel : std::enable_shared_from_this<Channel> {
+        libusb_device_handle* handle = nullptr;
+        EventLoop* loop = nullptr;
+        libusb_transfer* transfer = nullptr;
+        std::array<uint8_t, LIBUSB_CONTROL_SETUP_SIZE + reqLen> buffer{};
+        bool reading = false;  // GET_REPORT stage of the running command
+
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::deque<Command> queue;           // front() is running while busy
+        bool busy = false;
+        bool inFlight = false;               // libusb owns the transfer
+        bool closing = false;                // HID destroyed: the handle is about to close
+        std::shared_ptr<Channel> keepAlive;  // set while busy
+
+        ~Channel() { libusb_free_transfer(transfer); }
+
+        int submitTransfer() {
+            std::lock_guard lock(mutex);
+            // Checked with the destructor's lock held, so nothing is submitted on a closed handle
+            if (closing) return LIBUSB_ERROR_INTERRUPTED;
+            const int res = libusb_submit_transfer(transfer);
+            inFlight = res == LIBUSB_SUCCESS;
+            return res;
+        }
+
+        void startNext();
+        void finish(const HidResult& result);
+
+        LIBUSB_CALL static void transferDone(libusb_transfer* transfer);
+    };
+
+    HID::HID(libusb_device_handle* handle, EventLoop* loop)
+        : handle(handle), loop(loop), channel(std::make_shared<Channel>()) {
+        channel->handle = handle;
+        channel->loop = loop;
+        channel->transfer = libusb_alloc_transfer(0);
+        if (!channel->transfer) throw std::runtime_error("Cannot allocate HID transfer");
+    }
+
+    HID::~HID() {
+        std::unique_lock lock(channel->mutex);
+        // Queued commands never start; the running one is cancelled and completes as INTERRUPTED,
+        // including between its SET and GET stages, where no transfer is in flight
+        channel->closing = true;
+        if (channel->queue.size() > 1) {
+            auto& queue = channel->queue;
+            std::vector<Command> dropped(std::make_move_iterator(queue.begin() + 1),
+                                         std::make_move_iterator(queue.end()));
+            queue.erase(queue.begin() + 1, queue.end());
+            lock.unlock();
+            HidResult result;
+            result.error = LIBUSB_ERROR_INTERRUPTED;
+            for (auto& command : dropped) {
+                if (command.done) command.done(result);
+            }
+            lock.lock();
+        }
+        if (!channel->busy) return;
+
+        // Give the command a moment to finish so the handle is not closed under it; the
+        // Channel itself stays alive until the completion, however late
+        if (channel->inFlight) libusb_cancel_transfer(channel->transfer);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+        if (loop->inLoopThread()) {
+            // Nobody else completes it: run the events here
+            while (channel->busy && std::chrono::steady_clock::now() < deadline) {
+                lock.unlock();
+                struct timeval tv = {0, 10000};
+                libusb_handle_events_timeout(loop->getContext(), &tv);
+                lock.lock();
+            }
+        } else {
+            channel->idle.wait_until(lock, deadline, [this] { return !channel->busy; });
+        }
+    }
+
+    HID::Command HID::makeCommand(std::span<const uint8_t> command, HidCallback done, uint32_t timeout) const {
+        if (command.size() > reqLen - 1) throw std::runtime_error("HID command cannot be longer than 62 bytes");
+        Command next;
+        next.report[0] = 0x02; // 1 byte for direction, 62 bytes for command
+        std::copy(command.begin(), command.end(), next.report.begin() + 1);
+        next.length = static_cast<uint8_t>(command.size());
+        next.timeout = timeout;
+        next.done = std::move(done);
+        return next;
+    }
+
+    void HID::enqueue(std::vector<Command> commands) {
+        bool start;
+        {
+            std::lock_guard lock(channel->mutex);
+            for (auto& command : commands) channel->queue.push_back(std::move(command));
+            start = !channel->busy;
+            if (start) {
+                channel->busy = true;
+                channel->keepAlive = channel;
+            }
+        }
+        if (start) channel->startNext();
+    }
+
+    void HID::submit(std::span<const uint8_t> command, HidCallback done, uint32_t timeout) {
+        std::vector<Command> next;
+        next.push_back(makeCommand(command, std::move(done), timeout));
+        enqueue(std::move(next));
+    }
+
+    std::future<HidResult> HID::submit(std::span<const uint8_t> command, uint32_t timeout) {
+        auto promise = std::make_shared<std::promise<HidResult>>();
+        auto future = promise->get_future();
+        submit(command, [promise](const HidResult& result) { promise->set_value(result); }, timeout);
+        return future;
+    }
+
+    std::vector<std::future<HidResult>> HID::submitBatch(const std::vector<std::vector<uint8_t>>& commands,
+                                                         uint32_t timeout) {
+        std::vector<std::future<HidResult>> futures;
+        std::vector<Command> batch;
+        for (const auto& command : commands) {
+            auto promise = std::make_shared<std::promise<HidResult>>();
+            futures.push_back(promise->get_future());
+            batch.push_back(makeCommand(command, [promise](const HidResult& result) { promise->set_value(result); },
+                                        timeout));
+        }
+        if (!batch.empty()) enqueue(std::move(batch));
+        return futures;
+    }
+
+    HidResult HID::transact(std::span<const uint8_t> command, uint32_t timeout) {
+        if (loop->inLoopThread()) {
+            throw std::runtime_error("Blocking HID transaction on the USB event thread");
+        }
+        return submit(command, timeout).get();
+    }
+
+    void HID::Channel::startNext() {
+        const Command* command;
+        {
+            std::lock_guard lock(mutex);
+            command = &queue.front();
+        }
+        libusb_fill_control_setup(buffer.data(), LIBUSB_ENDPOINT_OUT | REQUEST_TYPE, SET_REPORT, 0x0202, 3, reqLen);
+        std::copy(command->report.begin(), command->report.end(), buffer.begin() + LIBUSB_CONTROL_SETUP_SIZE);
+        libusb_fill_control_transfer(transfer, handle, buffer.data(), &Channel::transferDone, this, command->timeout);
+        reading = false;
+        if (const int res = submitTransfer(); res != LIBUSB_SUCCESS) {
+            // Reported like any completion: on the event loop thread, never the submitter's
+            loop->post([self = shared_from_this(), res] {
+                HidResult result;
+                result.error = res;
+                self->finish(result);
+            });
+        }
+    }
+
+    void HID::Channel::transferDone(libusb_transfer* transfer) {
+        auto* self = static_cast<Channel*>(transfer->user_data);
+        {
+            std::lock_guard lock(self->mutex);
+            self->inFlight = false;
+        }
+        HidResult result;
+        if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
+            result.error = transferError(transfer->status);
+            return self->finish(result);
+        }
+
+        if (!self->reading) {
+            // Written: fetch the reply with the same transfer
+            std::fill(self->buffer.begin(), self->buffer.end(), 0);
+            libusb_fill_control_setup(self->buffer.data(), LIBUSB_ENDPOINT_IN | REQUEST_TYPE, GET_REPORT, 0x0101, 3,
+                                      reqLen);
+            self->reading = true;
+            if (const int res = self->submitTransfer(); res != LIBUSB_SUCCESS) {
+                result.error = res;
+                self->finish(result);
+            }
+            return;
+        }
+
+        const Command* command;
+        {
+            std::lock_guard lock(self->mutex);
+            command = &self->queue.front();
+        }
+        const uint8_t* receiveData = libusb_control_transfer_get_data(transfer);
+        const uint8_t cmdLen = command->length;
+        result.acknowledged = receiveData[0] == 0x01 &&
+                              std::equal(command->report.begin() + 1, command->report.begin() + cmdLen,
+                                         receiveData + 1);
+        result.size = static_cast<uint8_t>(reqLen - 1 - cmdLen);
+        std::copy_n(receiveData + cmdLen + 1, result.size, result.payload.begin());
+        self->finish(result);
+    }
+
+    void HID::Channel::finish(const HidResult& result) {
+        std::shared_ptr<Channel> release;  // destroyed last: may be the final reference
+        HidCallback done;
+        bool more;
+        {
+            std::lock_guard lock(mutex);
+            done = std::move(queue.front().done);
+            queue.pop_front();
+            more = !queue.empty();
+            if (!more) {
+                busy = false;
+                release = std::move(keepAlive);
+                idle.notify_all();
+            }
+        }
+        // Keep the device busy first, then report
+        if (more) startNext();
+        if (done) done(result);
     }
 
     void HID::write(std::array<uint8_t, 64>& data, const uint32_t timeout) const {
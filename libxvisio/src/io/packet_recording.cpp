@@ -0,0 +1,147 @@
+/**
+ * @file packet_recording.cpp
+ * @brief Chunked memory-mapped packet recorder and reader
+ */
+
+#include "packet_recording.h"
+#include "logging.h"
+#include "slam.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xv {
+
+using namespace recording;
+
+namespace {
+    ChunkHeader* headerOf(uint8_t* chunk) { return reinterpret_cast<ChunkHeader*>(chunk); }
+
+    const ChunkHeader* headerOf(const uint8_t* chunk) { return reinterpret_cast<const ChunkHeader*>(chunk); }
+
+    PacketRecord* recordsOf(uint8_t* chunk) { return reinterpret_cast<PacketRecord*>(chunk + sizeof(ChunkHeader)); }
+
+    const PacketRecord* recordsOf(const uint8_t* chunk) {
+        return reinterpret_cast<const PacketRecord*>(chunk + sizeof(ChunkHeader));
+    }
+}
+
+PacketRecorder::PacketRecorder(const std::string& path) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot create recording " + path + ": " + std::strerror(errno));
+    if (!mapChunk()) {
+        close(fd);
+        throw std::runtime_error("Cannot map recording " + path + ": " + std::strerror(errno));
+    }
+}
+
+PacketRecorder::PacketRecorder(Slam& slam, const std::string& path) : PacketRecorder(path) {
+    slam.registerPacketTap([this](const uint8_t* packet, int length, int64_t hostTimeNs) {
+        append(packet, length, hostTimeNs);
+    });
+}
+
+PacketRecorder::~PacketRecorder() {
+    unmapChunk();
+    close(fd);
+}
+
+bool PacketRecorder::mapChunk() {
+    const off_t offset = static_cast<off_t>(chunkIndex) * CHUNK_SIZE;
+    if (ftruncate(fd, offset + CHUNK_SIZE) != 0) return false;
+    void* mapped = mmap(nullptr, CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    if (mapped == MAP_FAILED) return false;
+
+    chunk = static_cast<uint8_t*>(mapped);
+    ChunkHeader* header = headerOf(chunk);
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->recordSize = sizeof(PacketRecord);
+    header->chunkIndex = chunkIndex;
+    header->count = 0;
+    return true;
+}
+
+void PacketRecorder::unmapChunk() {
+    if (!chunk) return;
+    // Trim the unused tail so the file ends right after the last record
+    const size_t used = sizeof(ChunkHeader) + headerOf(chunk)->count * sizeof(PacketRecord);
+    munmap(chunk, CHUNK_SIZE);
+    chunk = nullptr;
+    if (ftruncate(fd, static_cast<off_t>(chunkIndex) * CHUNK_SIZE + used) != 0) {
+        XV_WARN("Cannot trim recording: {}", std::strerror(errno));
+    }
+}
+
+void PacketRecorder::append(const uint8_t* packet, int length, int64_t hostTimeNs) {
+    if (failed) return;
+    ChunkHeader* header = headerOf(chunk);
+    if (header->count == RECORDS_PER_CHUNK) {
+        munmap(chunk, CHUNK_SIZE);
+        chunk = nullptr;
+        ++chunkIndex;
+        if (!mapChunk()) {
+            XV_ERROR("Recording stopped after {} packets: {}", total, std::strerror(errno));
+            failed = true;
+            return;
+        }
+        header = headerOf(chunk);
+    }
+
+    PacketRecord& record = recordsOf(chunk)[header->count];
+    record.hostTimeNs = hostTimeNs;
+    record.length = static_cast<uint8_t>(std::clamp(length, 0, int(record.data.size())));
+    std::memcpy(record.data.data(), packet, record.length);
+    std::fill(record.data.begin() + record.length, record.data.end(), 0);
+    // Count last: a crash mid-append leaves a shorter but valid chunk
+    header->count++;
+    total++;
+}
+
+PacketRecording::PacketRecording(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open recording " + path + ": " + std::strerror(errno));
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ChunkHeader))) {
+        close(fd);
+        throw std::runtime_error("Not a recording: " + path);
+    }
+    mappedBytes = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Cannot map recording " + path + ": " + std::strerror(errno));
+    mapping = static_cast<const uint8_t*>(mapped);
+
+    // Count records chunk by chunk; a short chunk (or a damaged one) ends the recording
+    for (size_t offset = 0; offset + sizeof(ChunkHeader) <= mappedBytes; offset += CHUNK_SIZE) {
+        const ChunkHeader* header = headerOf(mapping + offset);
+        if (header->magic != MAGIC || header->version != VERSION || header->recordSize != sizeof(PacketRecord)) {
+            break;
+        }
+        const size_t fits = (std::min(mappedBytes - offset, CHUNK_SIZE) - sizeof(ChunkHeader)) / sizeof(PacketRecord);
+        const size_t records = std::min<size_t>(header->count, fits);
+        count += records;
+        if (records < RECORDS_PER_CHUNK) break;
+    }
+    if (count == 0 && headerOf(mapping)->magic != MAGIC) {
+        munmap(const_cast<uint8_t*>(mapping), mappedBytes);
+        throw std::runtime_error("Not a recording: " + path);
+    }
+}
+
+PacketRecording::~PacketRecording() {
+    munmap(const_cast<uint8_t*>(mapping), mappedBytes);
+}
+
+PacketRecording::Packet PacketRecording::operator[](size_t index) const {
+    const uint8_t* chunk = mapping + (index / RECORDS_PER_CHUNK) * CHUNK_SIZE;
+    const PacketRecord& record = recordsOf(chunk)[index % RECORDS_PER_CHUNK];
+    return {record.hostTimeNs, record.length, record.data.data()};
+}
+
+} // namespace xv
@@ -0,0 +1,314 @@
+/**
+ * @file pose_log.cpp
+ * @brief Delta/varint column encoding, chunk index and the mapped pose log reader
+ */
+
+#include "pose_log.h"
+#include "logging.h"
+#include "slam.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xv {
+
+using namespace poselog;
+
+namespace {
+    constexpr auto DRAIN_WAIT = std::chrono::milliseconds(100);
+
+    /// Zigzag LEB128: small magnitudes of either sign take one byte
+    void putVarint(std::vector<uint8_t>& out, int64_t value) {
+        uint64_t bits = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+        while (bits >= 0x80) {
+            out.push_back(uint8_t(bits) | 0x80);
+            bits >>= 7;
+        }
+        out.push_back(uint8_t(bits));
+    }
+
+    /// One column stream; reads past its end yield 0
+    struct VarintReader {
+        const uint8_t* next;
+        const uint8_t* end;
+
+        int64_t read() {
+            uint64_t bits = 0;
+            for (int shift = 0; next < end && shift < 64; shift += 7) {
+                const uint8_t byte = *next++;
+                bits |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            return int64_t(bits >> 1) ^ -int64_t(bits & 1);
+        }
+    };
+
+    const ChunkHeader* chunkAt(const uint8_t* mapping, uint64_t offset) {
+        return reinterpret_cast<const ChunkHeader*>(mapping + offset);
+    }
+}
+
+PoseLogWriter::PoseLogWriter(const std::string& path) {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot create pose log " + path + ": " + std::strerror(errno));
+    FileHeader file{};
+    file.magic = MAGIC;
+    file.version = VERSION;
+    file.columns = COLUMNS;
+    file.chunkSamples = CHUNK_SAMPLES;
+    if (!writeAll(&file, sizeof(file))) {
+        const int error = errno;
+        close(fd);
+        throw std::runtime_error("Cannot write pose log " + path + ": " + std::strerror(error));
+    }
+    written = sizeof(file);
+    for (auto& column : columns) column.reserve(2 * CHUNK_SAMPLES);
+}
+
+PoseLogWriter::PoseLogWriter(Slam& slam, const std::string& path) : PoseLogWriter(path) {
+    follow(slam.openPoseRing());
+}
+
+PoseLogWriter::~PoseLogWriter() {
+    stopping = true;
+    ringChanged.notify_all();
+    if (drainer.joinable()) drainer.join();
+
+    flushChunk();
+    if (!failed) {
+        const Trailer trailer{INDEX_MAGIC, uint32_t(index.size()), written.load(), total.load(), 0};
+        if (!writeAll(index.data(), index.size() * sizeof(IndexEntry)) || !writeAll(&trailer, sizeof(trailer))) {
+            XV_WARN("Cannot write pose log index: {}", std::strerror(errno));
+        }
+    }
+    close(fd);
+}
+
+void PoseLogWriter::follow(std::shared_ptr<PoseRing> ring) {
+    {
+        std::lock_guard lock(ringMutex);
+        nextRing = std::move(ring);
+    }
+    ringChanged.notify_all();
+    if (!drainer.joinable()) drainer = std::thread(&PoseLogWriter::drain, this);
+}
+
+void PoseLogWriter::drain() {
+    std::shared_ptr<PoseRing> ring;
+    RawPose pose;
+    auto drainAll = [&] {
+        while (ring && ring->tryPop(pose)) append(pose);
+    };
+    while (!stopping) {
+        {
+            std::unique_lock lock(ringMutex);
+            if (!ring) ringChanged.wait_for(lock, DRAIN_WAIT, [this] { return nextRing || stopping.load(); });
+            if (nextRing) {
+                drainAll();  // the previous session's tail first
+                ring = std::move(nextRing);
+            }
+        }
+        if (ring && ring->waitFor(pose, DRAIN_WAIT)) {
+            append(pose);
+            drainAll();
+        }
+    }
+    drainAll();
+    std::lock_guard lock(ringMutex);
+    if (nextRing) {
+        ring = std::move(nextRing);
+        drainAll();
+    }
+}
+
+void PoseLogWriter::append(const RawPose& pose) {
+    if (failed) return;
+    const int64_t hostOffsetUs = pose.hostTimeNs / 1000 - pose.timeUs;
+    if (header.count == 0) {
+        header.magic = CHUNK_MAGIC;
+        header.firstTimeUs = pose.timeUs;
+        header.firstHostOffsetUs = hostOffsetUs;
+        header.firstTranslation = pose.translation;
+        header.firstQuaternion = pose.quaternion;
+        previous = pose;
+        previousDeltaUs = 0;
+        previousHostOffsetUs = hostOffsetUs;
+    }
+
+    const int64_t deltaUs = pose.timeUs - previous.timeUs;
+    putVarint(columns[Time], deltaUs - previousDeltaUs);
+    for (size_t axis = 0; axis < 3; ++axis) {
+        putVarint(columns[X + axis], int64_t(pose.translation[axis]) - previous.translation[axis]);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        putVarint(columns[QW + i], int64_t(pose.quaternion[i]) - previous.quaternion[i]);
+    }
+    putVarint(columns[HostOffset], hostOffsetUs - previousHostOffsetUs);
+    previous = pose;
+    previousDeltaUs = deltaUs;
+    previousHostOffsetUs = hostOffsetUs;
+
+    header.lastTimeUs = pose.timeUs;
+    header.count++;
+    total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (header.count == CHUNK_SAMPLES) flushChunk();
+}
+
+void PoseLogWriter::flushChunk() {
+    if (header.count == 0 || failed) return;
+    size_t payload = 0;
+    for (size_t c = 0; c < COLUMNS; ++c) {
+        header.columnBytes[c] = uint32_t(columns[c].size());
+        payload += columns[c].size();
+    }
+    const size_t padding = (8 - payload % 8) % 8;  // keeps every ChunkHeader 8-byte aligned
+    header.payloadBytes = uint32_t(payload + padding);
+
+    std::vector<uint8_t> block(sizeof(header));
+    block.reserve(sizeof(header) + header.payloadBytes);
+    std::memcpy(block.data(), &header, sizeof(header));
+    for (const auto& column : columns) block.insert(block.end(), column.begin(), column.end());
+    block.resize(block.size() + padding, 0);
+
+    if (!writeAll(block.data(), block.size())) {
+        XV_ERROR("Pose log stopped after {} samples: {}", total.load(), std::strerror(errno));
+        failed = true;
+        return;
+    }
+    index.push_back({written.load(), header.count, 0, header.firstTimeUs, header.lastTimeUs});
+    written.store(written.load() + block.size(), std::memory_order_relaxed);
+
+    header = ChunkHeader{};
+    for (auto& column : columns) column.clear();
+}
+
+bool PoseLogWriter::writeAll(const void* data, size_t length) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        const ssize_t n = write(fd, bytes, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        length -= size_t(n);
+    }
+    return true;
+}
+
+PoseLog::PoseLog(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open pose log " + path + ": " + std::strerror(errno));
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        close(fd);
+        throw std::runtime_error("Not a pose log: " + path);
+    }
+    mappedBytes = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Cannot map pose log " + path + ": " + std::strerror(errno));
+    mapping = static_cast<const uint8_t*>(mapped);
+
+    const auto* file = reinterpret_cast<const FileHeader*>(mapping);
+    if (file->magic != MAGIC || file->version != VERSION || file->columns != COLUMNS) {
+        munmap(const_cast<uint8_t*>(mapping), mappedBytes);
+        throw std::runtime_error("Not a pose log: " + path);
+    }
+
+    // The writer's index, if it got to write one
+    Trailer trailer{};
+    if (mappedBytes >= sizeof(FileHeader) + sizeof(Trailer)) {
+        std::memcpy(&trailer, mapping + mappedBytes - sizeof(Trailer), sizeof(trailer));
+    }
+    if (trailer.magic == INDEX_MAGIC &&
+        trailer.indexOffset + uint64_t(trailer.chunks) * sizeof(IndexEntry) + sizeof(Trailer) == mappedBytes) {
+        const auto* entries = reinterpret_cast<const IndexEntry*>(mapping + trailer.indexOffset);
+        index.assign(entries, entries + trailer.chunks);
+        samples = trailer.samples;
+        return;
+    }
+
+    // Cut short: walk the chunk headers; a truncated or damaged chunk ends the log
+    for (uint64_t offset = sizeof(FileHeader); offset + sizeof(ChunkHeader) <= mappedBytes;) {
+        const ChunkHeader* header = chunkAt(mapping, offset);
+        if (header->magic != CHUNK_MAGIC || offset + sizeof(ChunkHeader) + header->payloadBytes > mappedBytes) break;
+        uint64_t columnBytes = 0;
+        for (const uint32_t bytes : header->columnBytes) columnBytes += bytes;
+        if (columnBytes > header->payloadBytes) break;
+        index.push_back({offset, header->count, 0, header->firstTimeUs, header->lastTimeUs});
+        samples += header->count;
+        offset += sizeof(ChunkHeader) + header->payloadBytes;
+    }
+}
+
+PoseLog::~PoseLog() {
+    munmap(const_cast<uint8_t*>(mapping), mappedBytes);
+}
+
+void PoseLog::decode(size_t i, int64_t untilUs, std::vector<RawPose>& out) const {
+    const ChunkHeader* header = chunkAt(mapping, index[i].offset);
+    std::array<VarintReader, COLUMNS> readers;
+    const uint8_t* column = mapping + index[i].offset + sizeof(ChunkHeader);
+    for (size_t c = 0; c < COLUMNS; ++c) {
+        readers[c] = {column, column + header->columnBytes[c]};
+        column += header->columnBytes[c];
+    }
+
+    RawPose pose;
+    pose.timeUs = header->firstTimeUs;
+    pose.translation = header->firstTranslation;
+    pose.quaternion = header->firstQuaternion;
+    int64_t deltaUs = 0;
+    int64_t hostOffsetUs = header->firstHostOffsetUs;
+    for (uint32_t k = 0; k < header->count; ++k) {
+        deltaUs += readers[Time].read();
+        if (pose.timeUs + deltaUs > untilUs) return;
+        pose.timeUs += deltaUs;
+        for (size_t axis = 0; axis < 3; ++axis) pose.translation[axis] += int32_t(readers[X + axis].read());
+        for (size_t q = 0; q < 4; ++q) pose.quaternion[q] = int16_t(pose.quaternion[q] + readers[QW + q].read());
+        hostOffsetUs += readers[HostOffset].read();
+        pose.timestamp = uint32_t(pose.timeUs);
+        pose.hostTimeNs = (pose.timeUs + hostOffsetUs) * 1000;
+        out.push_back(pose);
+    }
+}
+
+void PoseLog::read(size_t i, std::vector<RawPose>& out) const {
+    decode(i, std::numeric_limits<int64_t>::max(), out);
+}
+
+std::vector<RawPose> PoseLog::range(int64_t fromUs, int64_t toUs) const {
+    std::vector<RawPose> out;
+    if (fromUs >= toUs) return out;
+    // First chunk that can hold fromUs: the last one starting at or before it
+    auto first = std::upper_bound(index.begin(), index.end(), fromUs,
+                                  [](int64_t t, const IndexEntry& entry) { return t < entry.firstTimeUs; });
+    if (first != index.begin()) --first;
+    for (auto entry = first; entry != index.end() && entry->firstTimeUs < toUs; ++entry) {
+        if (entry->lastTimeUs < fromUs) continue;
+        const size_t before = out.size();
+        decode(size_t(entry - index.begin()), toUs - 1, out);
+        const auto keepFrom = std::find_if(out.begin() + before, out.end(),
+                                           [fromUs](const RawPose& pose) { return pose.timeUs >= fromUs; });
+        out.erase(out.begin() + before, keepFrom);
+    }
+    return out;
+}
+
+std::optional<RawPose> PoseLog::at(int64_t timeUs) const {
+    const auto after = std::upper_bound(index.begin(), index.end(), timeUs,
+                                        [](int64_t t, const IndexEntry& entry) { return t < entry.firstTimeUs; });
+    if (after == index.begin()) return std::nullopt;
+    std::vector<RawPose> poses;
+    poses.reserve(CHUNK_SAMPLES);
+    decode(size_t(after - index.begin()) - 1, timeUs, poses);
+    if (poses.empty()) return std::nullopt;
+    return poses.back();
+}
+
+} // namespace xv
@@ -0,0 +1,136 @@
+/**
+ * @file replay_slam.cpp
+ * @brief Paced playback of recorded SLAM packets
+ */
+
+#include "replay_slam.h"
+#include <chrono>
+
+namespace xv {
+
+ReplaySlam::ReplaySlam(const std::string& path) : recording(path) {}
+
+ReplaySlam::~ReplaySlam() {
+    stop();
+}
+
+void ReplaySlam::start(double speed) {
+    stop();
+    hub.resetSession();
+    runThread = true;
+    hub.startDispatch();
+    replayThread = std::thread(&ReplaySlam::replayHandler, this, speed);
+}
+
+void ReplaySlam::stop() {
+    runThread = false;
+    if (replayThread.joinable()) {
+        replayThread.join();
+    }
+    hub.stopDispatch();
+}
+
+bool ReplaySlam::running() const {
+    return runThread;
+}
+
+int ReplaySlam::getFrameCount() const {
+    return hub.frameCount();
+}
+
+void ReplaySlam::registerSlamCallback(const slamCallback& callback) {
+    hub.registerSlamCallback(callback);
+}
+
+void ReplaySlam::registerRawSlamCallback(const rawSlamCallback& callback) {
+    hub.registerRawSlamCallback(callback);
+}
+
+void ReplaySlam::registerImuCallback(const imuCallback& callback) {
+    hub.registerImuCallback(callback);
+}
+
+void ReplaySlam::registerPacketTap(const packetTap& tap) {
+    hub.registerPacketTap(tap);
+}
+
+std::shared_ptr<PoseRing> ReplaySlam::openPoseRing() {
+    return hub.openPoseRing();
+}
+
+std::shared_ptr<ImuRing> ReplaySlam::openImuRing() {
+    return hub.openImuRing();
+}
+
+void ReplaySlam::setImuCalibration(const ImuCalibration& calibration) {
+    hub.setImuCalibration(calibration);
+}
+
+void ReplaySlam::setValidation(const ValidationOptions& options) {
+    hub.setValidation(options);
+}
+
+void ReplaySlam::setQuaternionConditioning(bool enabled) {
+    hub.setQuaternionConditioning(enabled);
+}
+
+void ReplaySlam::setSmoothing(const PoseFilterOptions& options) {
+    hub.setSmoothing(options);
+}
+
+PoseFilterOptions ReplaySlam::getSmoothing() const {
+    return hub.getSmoothing();
+}
+
+const ClockSync& ReplaySlam::clock() const {
+    return hub.clock();
+}
+
+std::optional<Pose> ReplaySlam::sampleAt(int64_t hostTimeNs) const {
+    return hub.sampleAt(hostTimeNs);
+}
+
+uint64_t ReplaySlam::getDroppedPoses() const {
+    return hub.droppedPoses();
+}
+
+SlamMetrics ReplaySlam::getMetrics() const {
+    SlamMetrics metrics;
+    hub.fillMetrics(metrics);
+    return metrics;
+}
+
+size_t ReplaySlam::size() const {
+    return recording.size();
+}
+
+void ReplaySlam::replayHandler(double speed) {
+    using Clock = std::chrono::steady_clock;
+    if (recording.size() == 0) {
+        runThread = false;
+        return;
+    }
+
+    const auto startTime = Clock::now();
+    const int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(startTime.time_since_epoch()).count();
+    const int64_t firstRecordedNs = recording[0].hostTimeNs;
+    const double scale = speed > 0.0 ? 1.0 / speed : 1.0;
+
+    for (size_t i = 0; i < recording.size() && runThread; ++i) {
+        const auto packet = recording[i];
+        const auto offsetNs = static_cast<int64_t>((packet.hostTimeNs - firstRecordedNs) * scale);
+
+        // Stamped with when it goes out, so sampleAt() and host-time consumers see no future poses
+        int64_t publishNs = startNs + offsetNs;
+        if (speed > 0.0) {
+            std::this_thread::sleep_until(startTime + std::chrono::nanoseconds(offsetNs));
+        } else {
+            while (hub.backlogged() && runThread) std::this_thread::yield();
+            publishNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        }
+        hub.publish(packet.data, packet.length, publishNs);
+    }
+    runThread = false;
+}
+
+} // namespace xv
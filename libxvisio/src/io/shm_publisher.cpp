@@ -0,0 +1,82 @@
+/**
+ * @file shm_publisher.cpp
+ * @brief Shared-memory segment creation, pose and fused-sample publishing
+ */
+
+#include "shm_publisher.h"
+#include "pose_fusion.h"
+#include "slam.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+namespace xv {
+
+namespace {
+    /// Map a segment read-write, reusing a compatible one so its sequence continues
+    template<typename Segment>
+    Segment* createSegment(const std::string& name) {
+        const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot create segment " + name + ": " + std::strerror(errno));
+
+        struct stat info{};
+        const bool reuse = fstat(fd, &info) == 0 && info.st_size == static_cast<off_t>(sizeof(Segment));
+        if (!reuse && ftruncate(fd, sizeof(Segment)) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot size segment " + name + ": " + std::strerror(errno));
+        }
+        void* mapping = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) throw std::runtime_error("Cannot map segment " + name + ": " + std::strerror(errno));
+
+        auto* segment = static_cast<Segment*>(mapping);
+        if (reuse && segment->compatible()) return segment;
+
+        // Fresh (zero-filled) or foreign layout: initialize, then mark valid
+        segment->magic.store(0, std::memory_order_relaxed);
+        new (&segment->ring) decltype(segment->ring)();
+        segment->version = Segment::VERSION;
+        segment->capacity = Segment::CAPACITY;
+        segment->itemSize = sizeof(typename Segment::Item);
+        segment->magic.store(Segment::MAGIC, std::memory_order_release);
+        return segment;
+    }
+}
+
+ShmPosePublisher::ShmPosePublisher(const std::string& name) : segment(createSegment<ShmPoseSegment>(name)) {}
+
+ShmPosePublisher::ShmPosePublisher(Slam& slam, const std::string& name) : ShmPosePublisher(name) {
+    subscription = slam.subscribe<RawPose>([this, &slam](const RawPose& raw) {
+        publish(raw.toPose(), slam.clock().deviceToHost(raw.timeUs));
+    });
+}
+
+ShmPosePublisher::~ShmPosePublisher() {
+    subscription.reset();  // the callback is not running once this returns
+    munmap(segment, sizeof(ShmPoseSegment));
+}
+
+void ShmPosePublisher::publish(const Pose& pose, int64_t hostTimeNs) {
+    segment->ring.push(SharedPose{pose, hostTimeNs});
+}
+
+void ShmPosePublisher::unlink(const std::string& name) {
+    shm_unlink(name.c_str());
+}
+
+ShmFusionPublisher::ShmFusionPublisher(const std::string& name) : segment(createSegment<ShmFusionSegment>(name)) {}
+
+ShmFusionPublisher::ShmFusionPublisher(PoseFusion& fusion, const std::string& name) : ShmFusionPublisher(name) {
+    subscription = fusion.registerFusedCallback([this](const FusedSample& sample) { publish(sample); });
+}
+
+ShmFusionPublisher::~ShmFusionPublisher() {
+    subscription.reset();  // a running push has left the callback once this returns
+    munmap(segment, sizeof(ShmFusionSegment));
+}
+
+void ShmFusionPublisher::publish(const FusedSample& sample) {
+    segment->ring.push(sample);
+}
+
+} // namespace xv
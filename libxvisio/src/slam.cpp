@@ -5,227 +5,495 @@
 
 #include "slam.h"
 #include "device.h"
+#include "event_loop.h"
+#include <algorithm>
 #include <array>
-#include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include "logging.h"
 
 namespace {
-    constexpr double FLOAT_SCALE = 6.103515625e-05;
     constexpr int MAX_RECOVERY_ATTEMPTS = 3;
     constexpr uint8_t SLAM_ENDPOINT = 0x83;
+    constexpr int PACKET_SIZE = 63;
+    constexpr uint8_t MAX_IN_FLIGHT = 32;
+
+    // Startup: probe instead of the official driver's fixed 1 s sleep
+    constexpr uint32_t PROBE_TIMEOUT_MS = 100;
+    constexpr auto PROBE_INTERVAL = std::chrono::milliseconds(20);
+    constexpr auto READY_TIMEOUT = std::chrono::seconds(2);
+    constexpr auto FIRST_POSE_TIMEOUT = std::chrono::milliseconds(250);  // before re-sending start-stream
+    constexpr auto STARTUP_TIMEOUT = std::chrono::seconds(3);
 }
 
 namespace xv {
 
+struct SlamContext;
+
+/// One queued interrupt transfer with its own buffer
+struct TransferSlot {
+    libusb_transfer* transfer = nullptr;
+    std::array<uint8_t, 64> buffer{};
+    SlamContext* ctx = nullptr;
+    uint64_t sequence = 0;  // submission order, restores packet order on completion
+    bool inFlight = false;
+};
+
+/// Completed packet parked until every earlier submission has been delivered
+struct PendingPacket {
+    std::array<uint8_t, 64> data{};
+    int length = 0;
+    int64_t hostTimeNs = 0;  // steady_clock at completion, before any queueing delay
+    bool done = false;       // completed or failed
+    bool valid = false;      // carries a packet to deliver
+};
+
 struct SlamContext {
-    std::vector<slamCallback>* callbacks;
-    std::atomic_bool* running;
+    PoseHub* hub;
+    EventLoop* loop;
+    RunFlag* running;
+    bool reconnect = false;              // device loss waits for the device instead of stopping
+    std::atomic_bool lost{false};
+    std::function<void()> onDeviceLost;  // runs on the loop thread
     libusb_device_handle* handle;
-    std::atomic<int>* frameCount;
     std::atomic<int> recoveryNeeded{0};  // 0 = ok, 1+ = recovery attempt number
+    std::vector<TransferSlot> slots;
+    std::vector<PendingPacket> window;   // 2x slots, indexed by sequence % size
+    uint64_t nextSubmit = 0;
+    uint64_t nextDeliver = 0;
+    std::weak_ptr<SlamContext> self;     // handed to loop tasks, which may outlive a teardown
 };
 
-Slam::Slam(Device* pDevice, libusb_context* libusbContext, libusb_device_handle* libusbDeviceHandle)
-    : device(pDevice), handle(libusbDeviceHandle), context(libusbContext) {}
+namespace {
+    void dispatchPacket(SlamContext* ctx, const PendingPacket& packet) {
+        ctx->hub->publish(packet.data.data(), packet.length, packet.hostTimeNs);
+    }
+
+    PendingPacket& pendingFor(SlamContext* ctx, uint64_t sequence) {
+        return ctx->window[sequence % ctx->window.size()];
+    }
+
+    /// Deliver parked packets in submission order, stopping at the first one still in flight
+    void drainInOrder(SlamContext* ctx) {
+        while (ctx->nextDeliver < ctx->nextSubmit) {
+            auto& pending = pendingFor(ctx, ctx->nextDeliver);
+            if (!pending.done) break;
+            if (pending.valid) dispatchPacket(ctx, pending);
+            ctx->nextDeliver++;
+        }
+    }
+
+    int submitSlot(TransferSlot& slot) {
+        auto* ctx = slot.ctx;
+        // A transfer stuck far behind the others must not stall delivery forever: give up on it
+        while (ctx->nextSubmit - ctx->nextDeliver >= ctx->window.size()) {
+            auto& oldest = pendingFor(ctx, ctx->nextDeliver);
+            if (oldest.done && oldest.valid) dispatchPacket(ctx, oldest);
+            ctx->nextDeliver++;
+        }
+
+        const int result = libusb_submit_transfer(slot.transfer);
+        if (result == LIBUSB_SUCCESS) {
+            slot.sequence = ctx->nextSubmit++;
+            slot.inFlight = true;
+            pendingFor(ctx, slot.sequence) = PendingPacket{};
+        }
+        return result;
+    }
+
+    /// NO_DEVICE from a transfer or libusb call: stop, or detach and wait for the device
+    void deviceGone(SlamContext* ctx) {
+        if (!ctx->reconnect) return ctx->running->clear();
+        if (ctx->lost.exchange(true)) return;
+        ctx->loop->post([weak = ctx->self] {
+            if (const auto locked = weak.lock()) locked->onDeviceLost();
+        });
+    }
+
+    /// Cancel every queued transfer and wait (bounded) for the cancellations to complete
+    void cancelAll(SlamContext* ctx, libusb_context* context) {
+        for (auto& slot : ctx->slots) {
+            if (slot.inFlight) libusb_cancel_transfer(slot.transfer);
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        auto anyInFlight = [ctx] {
+            return std::any_of(ctx->slots.begin(), ctx->slots.end(), [](const auto& s) { return s.inFlight; });
+        };
+        while (anyInFlight() && std::chrono::steady_clock::now() < deadline) {
+            struct timeval tv = {0, 10000};
+            libusb_handle_events_timeout(context, &tv);
+        }
+    }
+
+    /// (Re)queue every slot from a clean ordering state
+    int submitAll(SlamContext* ctx) {
+        ctx->nextDeliver = ctx->nextSubmit;
+        for (auto& slot : ctx->slots) {
+            if (const int res = submitSlot(slot); res != LIBUSB_SUCCESS) return res;
+        }
+        return LIBUSB_SUCCESS;
+    }
+}
+
+namespace {
+    /// Free every transfer once no callback can touch it any more
+    void freeAll(SlamContext* ctx) {
+        for (auto& slot : ctx->slots) libusb_free_transfer(slot.transfer);
+    }
+
+    void resubmit(const std::weak_ptr<SlamContext>& weak);
+
+    /// Runs as a loop task, OUTSIDE the transfer callbacks, where sync USB I/O is safe
+    void recover(const std::weak_ptr<SlamContext>& weak) {
+        const auto ctx = weak.lock();
+        if (!ctx || !ctx->running->isSet() || ctx->lost) return;
+
+        const int attempt = ctx->recoveryNeeded.load();
+        if (attempt > MAX_RECOVERY_ATTEMPTS) {
+            XV_ERROR("Recovery failed after {} attempts, stopping.", MAX_RECOVERY_ATTEMPTS);
+            ctx->running->clear();
+            return;
+        }
+
+        ctx->hub->metrics().recoveryAttempt();
+        // Every queued transfer is reset, not just the one that failed
+        cancelAll(ctx.get(), ctx->loop->getContext());
+
+        const int res = libusb_clear_halt(ctx->handle, SLAM_ENDPOINT);
+        if (res == LIBUSB_ERROR_NO_DEVICE) {
+            XV_WARN("Device gone during recovery");
+            deviceGone(ctx.get());
+            return;
+        }
+        if (res != LIBUSB_SUCCESS && res != LIBUSB_ERROR_NOT_FOUND) {
+            XV_WARN("clear_halt: {}", libusb_strerror(res));
+        }
+
+        // Back off without blocking the loop: other devices keep streaming meanwhile
+        ctx->loop->post([weak] { resubmit(weak); }, std::chrono::milliseconds(50 * attempt));
+    }
+
+    void resubmit(const std::weak_ptr<SlamContext>& weak) {
+        const auto ctx = weak.lock();
+        if (!ctx || !ctx->running->isSet() || ctx->lost) return;
+
+        const int res = submitAll(ctx.get());
+        if (res == LIBUSB_SUCCESS) {
+            XV_INFO("Recovered on attempt {}", ctx->recoveryNeeded.load());
+            ctx->hub->metrics().recovered();
+            ctx->recoveryNeeded.store(0);
+        } else if (res == LIBUSB_ERROR_NO_DEVICE) {
+            XV_WARN("Device gone during resubmit");
+            deviceGone(ctx.get());
+        } else {
+            XV_WARN("Resubmit failed: {}", libusb_strerror(res));
+            ctx->recoveryNeeded.fetch_add(1);
+            ctx->loop->post([weak] { recover(weak); });
+        }
+    }
+
+    /// Called from a transfer callback: flag the failure and let the loop recover
+    void requestRecovery(SlamContext* ctx) {
+        int expected = 0;
+        if (!ctx->lost && ctx->recoveryNeeded.compare_exchange_strong(expected, 1)) {
+            ctx->loop->post([weak = ctx->self] { recover(weak); });
+        }
+    }
+}
+
+Slam::Slam(Device* pDevice, EventLoop* eventLoop, libusb_device_handle* libusbDeviceHandle)
+    : device(pDevice), handle(libusbDeviceHandle), loop(eventLoop) {}
 
 Slam::~Slam() {
     stop();
 }
 
-void Slam::start(mode slamMode) {
+void Slam::start(mode newMode, uint8_t inFlight) {
+    std::lock_guard lock(lifecycle);
+    transferDepth = std::clamp<uint8_t>(inFlight, 1, MAX_IN_FLIGHT);
+    slamMode = newMode;
+    lost = false;
+    bringUp(true);
+}
+
+void Slam::bringUp(bool newSession) {
+    using Clock = std::chrono::steady_clock;
+    const auto began = Clock::now();
+    StartupTiming timing;
+    auto elapsed = [began] { return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - began); };
+    // resume() runs on the hotplug thread while getStartupTiming() may be read anywhere
+    auto publish = [this, began, &timing] {
+        std::lock_guard lock(timingMutex);
+        startedAt = began;
+        startup = timing;
+    };
+    publish();
+
     bool isEdge = (slamMode == mode::Edge);
     // Official XSlamDriver uses uvcMode=0 for Edge, we match that
     device->configureDevice(isEdge, 0, !isEdge);
+    timing.configured = elapsed();
+    publish();
+
+    // The official XSlamDriver sleeps 1s here. Poll the HID channel instead: the
+    // firmware stops answering while it reconfigures.
+    const auto readyBy = Clock::now() + READY_TIMEOUT;
+    while (!device->probe(PROBE_TIMEOUT_MS)) {
+        if (Clock::now() >= readyBy) throw std::runtime_error("Device not responding after configure");
+        std::this_thread::sleep_for(PROBE_INTERVAL);
+    }
+    timing.ready = elapsed();
+    publish();
+
+    if (newSession) {
+        hub.resetSession();
+        hub.setImuCalibration(device->getImuCalibration());
+        runThread.set();
+        hub.startDispatch();
+    } else {
+        hub.expectDeviceRestart();
+    }
+    // Transfers are queued before the stream starts so the first packet is not left waiting
+    loop->runSync([this] { startStreaming(); });
+
+    // A start-stream command sent while the pipeline is still coming up is ignored: repeat it
+    // until the first 01 A2 33 packet shows up.
+    const auto startBy = Clock::now() + STARTUP_TIMEOUT;
+    while (runThread.isSet() && Clock::now() < startBy) {
+        // edgeMode must match: 1 for Edge SLAM, 0 for Mixed/host-assisted
+        // rotationEnabled=true needed for live rotation data (false freezes quaternion)
+        device->startEdgeStream(isEdge ? 1 : 0, true, false);
+        timing.streamRequests++;
+        publish();
+        if (hub.waitFirstPacket(FIRST_POSE_TIMEOUT)) break;
+    }
 
-    // Official XSlamDriver sleeps 1s between configure and startEdgeStream
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    // edgeMode must match: 1 for Edge SLAM, 0 for Mixed/host-assisted
-    // rotationEnabled=true needed for live rotation data (false freezes quaternion)
-    device->startEdgeStream(isEdge ? 1 : 0, true, false);
-    frameCount = 0;
-    runThread = true;
-    slamThread = std::thread(&Slam::slamHandler, this);
+    if (const auto first = getStartupTiming().firstPose; first.count() > 0) {
+        XV_INFO("First pose {} ms after start (ready at {} ms, {} stream request(s))", first.count() / 1000.0,
+                timing.ready.count() / 1000.0, timing.streamRequests);
+    } else if (runThread.isSet()) {
+        XV_WARN("No SLAM packet within {} s of start", STARTUP_TIMEOUT.count());
+    }
 }
 
 void Slam::stop() {
-    runThread = false;
-    if (slamThread.joinable()) {
-        slamThread.join();
+    std::lock_guard lock(lifecycle);
+    runThread.clear();
+    loop->runSync([this] { teardown(); });
+    lost = false;
+    hub.stopDispatch();
+}
+
+void Slam::deviceLost() {
+    XV_WARN("Device lost after {} frames, waiting for it to return", hub.frameCount());
+    lost = true;
+    teardown();
+    device->detach();
+}
+
+void Slam::resume(libusb_device_handle* newHandle) {
+    std::lock_guard lock(lifecycle);
+    handle = newHandle;
+    if (!runThread.isSet() || !lost) return;
+
+    try {
+        bringUp(false);
+        lost = false;
+        reconnects.fetch_add(1);
+    } catch (const std::runtime_error& e) {
+        // Gone again (or not ready): wait for the next arrival
+        XV_WARN("Resume failed: {}", e.what());
+        loop->runSync([this] { teardown(); });
+        device->detach();
+    }
+}
+
+void Slam::startStreaming() {
+    teardown();
+    // Same thread as detach(): a device lost during bringUp() never gets transfers on its closed handle
+    if (!device->isConnected()) return;
+    streaming = std::make_shared<SlamContext>();
+    auto* ctx = streaming.get();
+    ctx->self = streaming;
+    ctx->hub = &hub;
+    ctx->loop = loop;
+    ctx->running = &runThread;
+    ctx->reconnect = autoReconnect;
+    ctx->onDeviceLost = [this] { deviceLost(); };
+    ctx->handle = handle;
+    ctx->slots = std::vector<TransferSlot>(transferDepth);
+    ctx->window = std::vector<PendingPacket>(2 * transferDepth);
+
+    for (auto& slot : ctx->slots) {
+        slot.ctx = ctx;
+        slot.transfer = libusb_alloc_transfer(0);
+        libusb_fill_interrupt_transfer(slot.transfer, handle, SLAM_ENDPOINT, slot.buffer.data(), PACKET_SIZE,
+                                       &Slam::usbCallback, &slot, 5000);
+    }
+
+    if (int result = submitAll(ctx); result != LIBUSB_SUCCESS) {
+        XV_ERROR("Initial transfer error: {}", libusb_strerror(result));
+        runThread.clear();
+        teardown();
     }
 }
 
+void Slam::teardown() {
+    if (!streaming) return;
+    // Wait for the cancellations to complete before freeing
+    cancelAll(streaming.get(), loop->getContext());
+    freeAll(streaming.get());
+    streaming.reset();  // pending recovery tasks see an expired context and do nothing
+}
+
 bool Slam::running() const {
-    return runThread;
+    return runThread.isSet();
+}
+
+bool Slam::waitUntilStopped(std::chrono::milliseconds timeout) {
+    return runThread.waitCleared(timeout);
+}
+
+StartupTiming Slam::getStartupTiming() const {
+    std::lock_guard lock(timingMutex);
+    StartupTiming timing = startup;
+    if (const int64_t first = hub.firstPacketHostNs()) {
+        const auto started = std::chrono::duration_cast<std::chrono::nanoseconds>(startedAt.time_since_epoch()).count();
+        timing.firstPose = std::chrono::microseconds((first - started) / 1000);
+    }
+    return timing;
+}
+
+SlamMetrics Slam::getMetrics() const {
+    SlamMetrics metrics;
+    hub.fillMetrics(metrics);
+    metrics.reconnects = reconnects.load();
+    return metrics;
 }
 
 int Slam::getFrameCount() const {
-    return frameCount;
+    return hub.frameCount();
+}
+
+const ClockSync& Slam::clock() const {
+    return hub.clock();
+}
+
+std::optional<Pose> Slam::sampleAt(int64_t hostTimeNs) const {
+    return hub.sampleAt(hostTimeNs);
 }
 
 void Slam::registerSlamCallback(const std::function<void(Pose)>& callback) {
-    callbacks.push_back(callback);
+    hub.registerSlamCallback(callback);
 }
 
-void Slam::slamHandler() {
-    libusb_transfer* transfer = libusb_alloc_transfer(0);
-    auto buffer = std::make_shared<std::array<uint8_t, 64>>();
-    auto ctx = new SlamContext{&callbacks, &runThread, handle, &frameCount};
+void Slam::registerRawSlamCallback(const rawSlamCallback& callback) {
+    hub.registerRawSlamCallback(callback);
+}
 
-    libusb_fill_interrupt_transfer(transfer, handle, SLAM_ENDPOINT, buffer->data(), 63,
-                                   &Slam::usbCallback, ctx, 5000);
+void Slam::registerImuCallback(const imuCallback& callback) {
+    hub.registerImuCallback(callback);
+}
 
-    if (int result = libusb_submit_transfer(transfer); result != LIBUSB_SUCCESS) {
-        std::cerr << "[XR50] Initial transfer error: " << libusb_strerror(result) << std::endl;
-        runThread = false;
-        libusb_free_transfer(transfer);
-        delete ctx;
-        return;
-    }
+std::shared_ptr<ImuRing> Slam::openImuRing() {
+    return hub.openImuRing();
+}
 
-    while (runThread) {
-        struct timeval tv = {0, 1000};  // 1ms timeout
-        libusb_handle_events_timeout(context, &tv);
+void Slam::registerPacketTap(const packetTap& tap) {
+    hub.registerPacketTap(tap);
+}
 
-        // Recovery runs here, OUTSIDE the async callback, where sync USB I/O is safe
-        int attempt = ctx->recoveryNeeded.load();
-        if (attempt > 0) {
-            if (attempt > MAX_RECOVERY_ATTEMPTS) {
-                std::cerr << "[XR50] Recovery failed after " << MAX_RECOVERY_ATTEMPTS
-                          << " attempts, stopping." << std::endl;
-                runThread = false;
-                break;
-            }
+std::shared_ptr<PoseRing> Slam::openPoseRing() {
+    return hub.openPoseRing();
+}
 
-            int res = libusb_clear_halt(handle, SLAM_ENDPOINT);
-            if (res == LIBUSB_ERROR_NO_DEVICE) {
-                std::cerr << "[XR50] Device gone during recovery, stopping." << std::endl;
-                runThread = false;
-                break;
-            }
-            if (res != LIBUSB_SUCCESS && res != LIBUSB_ERROR_NOT_FOUND) {
-                std::cerr << "[XR50] clear_halt: " << libusb_strerror(res) << std::endl;
-            }
+void Slam::setThreadPolicy(const ThreadPolicy& policy) {
+    loop->setThreadPolicy(policy);
+}
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(50 * attempt));
-
-            res = libusb_submit_transfer(transfer);
-            if (res == LIBUSB_SUCCESS) {
-                std::cerr << "[XR50] Recovered on attempt " << attempt << std::endl;
-                ctx->recoveryNeeded.store(0);
-            } else if (res == LIBUSB_ERROR_NO_DEVICE) {
-                std::cerr << "[XR50] Device gone during resubmit, stopping." << std::endl;
-                runThread = false;
-                break;
-            } else {
-                std::cerr << "[XR50] Resubmit failed: " << libusb_strerror(res) << std::endl;
-                ctx->recoveryNeeded.fetch_add(1);
-            }
-        }
-    }
+void Slam::setValidation(const ValidationOptions& options) {
+    hub.setValidation(options);
+}
+
+void Slam::setQuaternionConditioning(bool enabled) {
+    hub.setQuaternionConditioning(enabled);
+}
 
-    libusb_cancel_transfer(transfer);
-    // Drain pending events so the cancel completes before we free
-    struct timeval tv = {0, 100000};
-    libusb_handle_events_timeout(context, &tv);
-    libusb_free_transfer(transfer);
-    delete ctx;
+void Slam::setSmoothing(const PoseFilterOptions& options) {
+    hub.setSmoothing(options);
+}
+
+PoseFilterOptions Slam::getSmoothing() const {
+    return hub.getSmoothing();
+}
+
+uint64_t Slam::getDroppedPoses() const {
+    return hub.droppedPoses();
 }
 
 void Slam::usbCallback(libusb_transfer* transfer) {
-    auto* ctx = static_cast<SlamContext*>(transfer->user_data);
+    auto& slot = *static_cast<TransferSlot*>(transfer->user_data);
+    auto* ctx = slot.ctx;
+    slot.inFlight = false;
+    // Given up on by submitSlot(): its window entry now belongs to a newer submission
+    const bool stale = slot.sequence < ctx->nextDeliver;
 
     if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
         if (transfer->status == LIBUSB_TRANSFER_CANCELLED) return;
-        if (!ctx->running->load()) return;
+        if (!ctx->running->isSet() || ctx->lost) return;
+        ctx->hub->metrics().transferError(transfer->status);
 
         const char* statusNames[] = {
             "COMPLETED", "ERROR", "TIMED_OUT", "CANCELLED", "STALL", "NO_DEVICE", "OVERFLOW"
         };
         int si = transfer->status;
-        std::cerr << "[XR50] Transfer " << ((si >= 0 && si <= 6) ? statusNames[si] : "UNKNOWN")
-                  << " after " << ctx->frameCount->load() << " frames" << std::endl;
+        XV_WARN("Transfer {} after {} frames", (si >= 0 && si <= 6) ? statusNames[si] : "UNKNOWN",
+                ctx->hub->frameCount());
 
         if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
-            ctx->running->store(false);
+            deviceGone(ctx);
             return;
         }
 
+        // Release the packets queued behind this one, then let the event loop recover
+        if (!stale) {
+            pendingFor(ctx, slot.sequence).done = true;
+            drainInOrder(ctx);
+        }
+
         // Signal the event loop to handle recovery (no sync USB I/O in callbacks!)
-        ctx->recoveryNeeded.store(1);
+        requestRecovery(ctx);
         return;
     }
 
+    const auto received = std::chrono::steady_clock::now().time_since_epoch();
+
+    // Park the packet so the buffer can be reused right away; a stale one is dropped (out of order)
+    if (!stale) {
+        auto& pending = pendingFor(ctx, slot.sequence);
+        pending.hostTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(received).count();
+        pending.length = std::min(transfer->actual_length, PACKET_SIZE);
+        std::copy_n(transfer->buffer, pending.length, pending.data.begin());
+        pending.done = true;
+        pending.valid = true;
+    }
+
     // Resubmit FIRST for lowest latency (libusb_submit_transfer is safe in callbacks)
-    if (ctx->running->load()) {
-        int result = libusb_submit_transfer(transfer);
+    if (ctx->running->isSet() && ctx->recoveryNeeded.load() == 0) {
+        int result = submitSlot(slot);
         if (result != LIBUSB_SUCCESS) {
             if (result == LIBUSB_ERROR_NO_DEVICE) {
-                std::cerr << "[XR50] Device gone after " << ctx->frameCount->load() << " frames" << std::endl;
-                ctx->running->store(false);
+                XV_WARN("Device gone after {} frames", ctx->hub->frameCount());
+                deviceGone(ctx);
                 return;
             }
             // Signal recovery — don't call libusb_clear_halt() here
-            ctx->recoveryNeeded.store(1);
-            return;
-        }
-    }
-
-    // Parse pose data
-    auto* buffer = transfer->buffer;
-    int frame = ctx->frameCount->load();
-
-    // Dump raw hex: first 3 frames of every session + every 200th
-    if (frame < 3 || frame % 200 == 0) {
-        std::cerr << "[XR50] Frame " << frame << " raw (" << transfer->actual_length << "B): ";
-        for (int i = 0; i < transfer->actual_length && i < 63; i++) {
-            char hex[4];
-            snprintf(hex, sizeof(hex), "%02x", buffer[i]);
-            std::cerr << hex;
-            // Separators: header | timestamp | translation(12B) | quat(8B) | rest
-            if (i == 2 || i == 6 || i == 18 || i == 26) std::cerr << " | ";
-            else std::cerr << " ";
+            requestRecovery(ctx);
         }
-        std::cerr << std::endl;
     }
 
-    auto timestamp = *reinterpret_cast<uint32_t*>(&buffer[3]);
-    auto* translationData = reinterpret_cast<int32_t*>(&buffer[7]);
-
-    Vector3 position = {
-        translationData[0] * FLOAT_SCALE,
-        translationData[1] * FLOAT_SCALE,
-        translationData[2] * FLOAT_SCALE
-    };
-
-    // Wire format is [w, x, y, z] (quatData[0]=w ≈ -1.0 for identity)
-    // Note: SDK API uses [qx,qy,qz,qw] but device sends w first
-    auto* quatData = reinterpret_cast<int16_t*>(&buffer[19]);
-    Vector4 quaternion = {
-        quatData[0] * FLOAT_SCALE,  // w
-        quatData[1] * FLOAT_SCALE,  // x
-        quatData[2] * FLOAT_SCALE,  // y
-        quatData[3] * FLOAT_SCALE   // z
-    };
-
-    // Log quaternion and extra bytes for first few frames
-    if (frame < 5) {
-        std::cerr << "[XR50] Quat: w=" << quaternion[0] << " x=" << quaternion[1]
-                  << " y=" << quaternion[2] << " z=" << quaternion[3] << std::endl;
-        // Dump bytes 27-50 as int16 to look for more data
-        std::cerr << "[XR50] Extra int16 @27: ";
-        for (int i = 27; i + 1 < 63; i += 2) {
-            auto val = *reinterpret_cast<int16_t*>(&buffer[i]);
-            std::cerr << val << " ";
-        }
-        std::cerr << std::endl;
-    }
-
-    Pose pose{position, quaternion, timestamp};
-    ctx->frameCount->fetch_add(1);
-
-    for (const auto& callback : *ctx->callbacks) {
-        callback(pose);
-    }
+    drainInOrder(ctx);
 }
 
 } // namespace xv
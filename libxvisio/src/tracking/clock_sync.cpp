@@ -0,0 +1,129 @@
+/**
+ * @file clock_sync.cpp
+ * @brief Min-filtered linear regression of host receive time on device time
+ */
+
+#include "clock_sync.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace xv {
+
+namespace {
+    constexpr int64_t BUCKET_US = 500000;
+    constexpr int64_t MIN_DRIFT_SPAN_US = 2000000;  // shorter fits are dominated by jitter
+    constexpr int64_t DISCONTINUITY_NS = 1000000000;
+}
+
+int64_t ClockSync::unwrap(uint32_t timestamp) {
+    // Signed 32-bit difference carries the counter across its ~71.6 min wrap
+    unwrappedUs = unwrappedUs < 0 ? timestamp : unwrappedUs + static_cast<int32_t>(timestamp - lastTimestamp);
+    lastTimestamp = timestamp;
+    return unwrappedUs;
+}
+
+int64_t ClockSync::rebase(uint32_t timestamp, int64_t hostTimeNs) {
+    if (unwrappedUs < 0) return unwrap(timestamp);
+    unwrappedUs = std::max(hostToDevice(hostTimeNs), unwrappedUs + 1);
+    lastTimestamp = timestamp;
+    return unwrappedUs;
+}
+
+void ClockSync::observe(int64_t deviceTimeUs, int64_t hostTimeNs) {
+    const int64_t offset = hostTimeNs - deviceTimeUs * 1000;
+
+    if (currentStartUs >= 0) {
+        const int64_t delay = latency(deviceTimeUs, hostTimeNs);
+        if (std::llabs(delay) > DISCONTINUITY_NS) {
+            restart();
+        } else {
+            lastLatencyNs.store(delay, std::memory_order_relaxed);
+        }
+    }
+
+    if (currentStartUs < 0) {
+        currentStartUs = deviceTimeUs;
+        current = {deviceTimeUs, offset};
+        lastLatencyNs.store(0, std::memory_order_relaxed);
+        return publish();
+    }
+
+    if (deviceTimeUs - currentStartUs >= BUCKET_US) {
+        buckets[(bucketHead + bucketCount) % MAX_BUCKETS] = current;
+        if (bucketCount < MAX_BUCKETS) {
+            ++bucketCount;
+        } else {
+            bucketHead = (bucketHead + 1) % MAX_BUCKETS;
+        }
+        currentStartUs = deviceTimeUs;
+        current = {deviceTimeUs, offset};
+        return publish();
+    }
+
+    if (offset < current.offsetNs) {
+        current = {deviceTimeUs, offset};
+        // Until the first bucket closes, the running minimum is the whole estimate
+        if (bucketCount == 0) publish();
+    }
+}
+
+void ClockSync::restart() {
+    bucketCount = 0;
+    bucketHead = 0;
+    currentStartUs = -1;
+}
+
+void ClockSync::publish() {
+    // Fit offset = a + b * (device - ref) through the bucket minima and the open bucket
+    const Minimum& ref = current;
+    const size_t n = bucketCount + 1;
+    auto point = [&](size_t i) { return i < bucketCount ? buckets[(bucketHead + i) % MAX_BUCKETS] : current; };
+
+    double meanX = 0.0, meanY = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        meanX += static_cast<double>(point(i).deviceTimeUs - ref.deviceTimeUs) / n;
+        meanY += static_cast<double>(point(i).offsetNs - ref.offsetNs) / n;
+    }
+
+    double slope = 0.0;  // ns of offset per µs of device time
+    if (ref.deviceTimeUs - point(0).deviceTimeUs >= MIN_DRIFT_SPAN_US) {
+        double sxy = 0.0, sxx = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const double dx = static_cast<double>(point(i).deviceTimeUs - ref.deviceTimeUs) - meanX;
+            const double dy = static_cast<double>(point(i).offsetNs - ref.offsetNs) - meanY;
+            sxy += dx * dy;
+            sxx += dx * dx;
+        }
+        slope = sxy / sxx;
+    }
+    const double intercept = n == 1 ? 0.0 : meanY - slope * meanX;
+
+    estimates.push(Estimate{ref.deviceTimeUs, ref.deviceTimeUs * 1000 + ref.offsetNs + std::llround(intercept),
+                            slope / 1000.0});
+}
+
+int64_t ClockSync::deviceToHost(int64_t deviceTimeUs) const {
+    Estimate e{};
+    if (!estimates.latest(e)) return 0;
+    const double delta = static_cast<double>(deviceTimeUs - e.deviceRefUs);
+    return e.hostRefNs + std::llround(delta * 1000.0 * (1.0 + e.drift));
+}
+
+int64_t ClockSync::hostToDevice(int64_t hostTimeNs) const {
+    Estimate e{};
+    if (!estimates.latest(e)) return 0;
+    const double delta = static_cast<double>(hostTimeNs - e.hostRefNs);
+    return e.deviceRefUs + std::llround(delta / (1000.0 * (1.0 + e.drift)));
+}
+
+int64_t ClockSync::latency(int64_t deviceTimeUs, int64_t hostTimeNs) const {
+    return hostTimeNs - deviceToHost(deviceTimeUs);
+}
+
+double ClockSync::driftPpm() const {
+    Estimate e{};
+    return estimates.latest(e) ? e.drift * 1e6 : 0.0;
+}
+
+} // namespace xv
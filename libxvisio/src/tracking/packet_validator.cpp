@@ -0,0 +1,98 @@
+/**
+ * @file packet_validator.cpp
+ * @brief Header, timestamp and motion-bound checks with optional substitution
+ */
+
+#include "packet_validator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace xv {
+
+namespace {
+    /// Motion bounds never assume less time than one nominal packet interval; arrival jitter
+    /// can put two packets a few µs apart on the device clock
+    constexpr double MIN_INTERVAL_S = 1e-3;
+}
+
+bool PacketValidator::admit(const uint8_t* packet, int length) {
+    if (length < SLAM_PACKET_LENGTH) {
+        metrics.rejected(Rejection::Length);
+        return false;
+    }
+    if (!RawPose::isSlamPacket(packet, length)) {
+        metrics.rejected(Rejection::Header);
+        return false;
+    }
+    return true;
+}
+
+bool PacketValidator::plausibleMotion(const RawPose& pose, double dt) const {
+    const double interval = std::max(dt, MIN_INTERVAL_S);
+    if (options.maxSpeed > 0.0) {
+        double distance = 0.0;  // squared, in fixed-point units
+        for (size_t i = 0; i < 3; ++i) {
+            const double d = double(pose.translation[i]) - double(last.translation[i]);
+            distance += d * d;
+        }
+        const double limit = options.maxSpeed * interval / FIXED_POINT_SCALE;
+        if (distance > limit * limit) return false;
+    }
+    if (options.maxAngularSpeed > 0.0) {
+        // The rotation between two quaternions is at most angle when (a·b)^2 >= cos^2(angle/2) |a|^2 |b|^2.
+        // cos^2(x) >= 1 - x^2, so the bound below errs towards accepting and needs no trigonometry.
+        int64_t dot = 0, normPose = 0, normLast = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            dot += int32_t(pose.quaternion[i]) * last.quaternion[i];
+            normPose += int32_t(pose.quaternion[i]) * pose.quaternion[i];
+            normLast += int32_t(last.quaternion[i]) * last.quaternion[i];
+        }
+        if (normPose == 0) return false;
+        const double halfAngle = options.maxAngularSpeed * interval / 2.0;
+        const double bound = std::max(1.0 - halfAngle * halfAngle, 0.0);
+        if (double(dot) * double(dot) < bound * double(normPose) * double(normLast)) return false;
+    }
+    return true;
+}
+
+bool PacketValidator::admit(RawPose& pose) {
+    if (references == 0) return accept(pose);
+
+    // Signed difference: the counter wraps every ~71.6 min
+    const int32_t stepUs = static_cast<int32_t>(pose.timestamp - last.timestamp);
+    Rejection reason = Rejection::Timestamp;
+    if (stepUs > 0 && stepUs <= options.maxStepUs) {
+        if (plausibleMotion(pose, stepUs * 1e-6)) return accept(pose);
+        reason = Rejection::Motion;
+    }
+
+    // A long run is the stream itself moving on, not one bad packet: start over from here
+    if (rejectedInRow >= options.maxConsecutive) {
+        references = 0;
+        return accept(pose);
+    }
+    rejectedInRow++;
+    metrics.rejected(reason);
+    if (reason != Rejection::Motion || !options.substitute) return false;
+
+    // Constant velocity from the last two accepted poses; orientation held
+    const int32_t spanUs = references > 1 ? static_cast<int32_t>(last.timestamp - previous.timestamp) : 0;
+    const double ratio = spanUs > 0 ? double(stepUs) / spanUs : 0.0;
+    for (size_t i = 0; i < 3; ++i) {
+        const double velocity = double(last.translation[i]) - double(previous.translation[i]);
+        pose.translation[i] = last.translation[i] + int32_t(std::lround(velocity * ratio));
+    }
+    pose.quaternion = last.quaternion;
+    metrics.substituted();
+    return true;
+}
+
+bool PacketValidator::accept(const RawPose& pose) {
+    previous = last;
+    last = pose;
+    references = std::min(references + 1, 2);
+    rejectedInRow = 0;
+    return true;
+}
+
+} // namespace xv
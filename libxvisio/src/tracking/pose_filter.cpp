@@ -0,0 +1,85 @@
+/**
+ * @file pose_filter.cpp
+ * @brief Adaptive slerp for orientation and the RawPose smoothing stage
+ */
+
+#include "pose_filter.h"
+#include "quaternion.h"
+#include <algorithm>
+#include <limits>
+
+namespace xv {
+
+namespace {
+    /// Longer than this between samples (or time going backwards) starts the filter over
+    constexpr int64_t MAX_GAP_US = 100000;
+
+    template<typename T>
+    T toFixed(double value) {
+        const double scaled = std::round(value / FIXED_POINT_SCALE);
+        return T(std::clamp<double>(scaled, std::numeric_limits<T>::min(), std::numeric_limits<T>::max()));
+    }
+}
+
+Vector4 RotationFilter::operator()(const Vector4& value, double dt, const OneEuroParams& params) {
+    const Vector4 q = quat::normalize(value);
+    if (!primed) {
+        filtered = q;
+        speed = 0.0;
+        primed = true;
+    } else if (dt > 0.0) {
+        const Vector4 target = quat::alignHemisphere(q, filtered);
+        const Vector3 omega = quat::toAngularVelocity(quat::multiply(quat::conjugate(filtered), target), dt);
+        speed += detail::smoothingFactor(params.derivativeCutoff, dt) *
+                 (std::sqrt(omega[0] * omega[0] + omega[1] * omega[1] + omega[2] * omega[2]) - speed);
+        const double cutoff = params.minCutoff + params.beta * speed;
+        filtered = quat::normalize(quat::slerp(filtered, target, detail::smoothingFactor(cutoff, dt)));
+    }
+    return filtered;
+}
+
+PoseFilter::PoseFilter(Options options) : active(options) {
+    settings.push(options);
+    activeVersion = settings.count();
+}
+
+void PoseFilter::setOptions(const Options& options) {
+    std::lock_guard lock(writer);
+    settings.push(options);
+}
+
+PoseFilter::Options PoseFilter::getOptions() const {
+    Options out;
+    while (!settings.latest(out)) {}  // only fails while a setter is mid-push
+    return out;
+}
+
+void PoseFilter::reset() {
+    positionFilter.reset();
+    rotationFilter.reset();
+}
+
+void PoseFilter::apply(RawPose& pose) {
+    // One acquire load per sample unless someone changed the settings
+    if (const uint64_t version = settings.count(); version != activeVersion) {
+        Options next;
+        if (settings.read(version - 1, next)) {
+            if (next.enabled && !active.enabled) reset();
+            active = next;
+            activeVersion = version;
+        }
+    }
+    if (!active.enabled) return;
+
+    const int64_t elapsedUs = pose.timeUs - lastTimeUs;
+    lastTimeUs = pose.timeUs;
+    if (elapsedUs < 0 || elapsedUs > MAX_GAP_US) reset();
+    const double dt = elapsedUs * 1e-6;
+
+    const Vector3 position = positionFilter(pose.position(), dt, active.position);
+    const Vector4 orientation = rotationFilter(pose.orientation(), dt, active.rotation);
+    for (size_t i = 0; i < 3; ++i) pose.translation[i] = toFixed<int32_t>(position[i]);
+    for (size_t i = 0; i < 4; ++i) pose.quaternion[i] = toFixed<int16_t>(orientation[i]);
+}
+
+} // namespace xv
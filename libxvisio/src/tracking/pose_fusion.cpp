@@ -0,0 +1,110 @@
+/**
+ * @file pose_fusion.cpp
+ * @brief Source clock mapping, head-pose lookup and the world transform of external samples
+ */
+
+#include "pose_fusion.h"
+#include "quaternion.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace xv {
+
+namespace {
+    Matrix3 multiply(const Matrix3& a, const Matrix3& b) {
+        Matrix3 out{};
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) out[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+        return out;
+    }
+
+    Vector3 transform(const Matrix3& m, const Vector3& t, const Vector3& v) {
+        return {m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2] + t[0],
+                m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2] + t[1],
+                m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2] + t[2]};
+    }
+
+    template<size_t N>
+    std::array<float, N> toFloat(const std::array<double, N>& values) {
+        std::array<float, N> out{};
+        for (size_t i = 0; i < N; ++i) out[i] = float(values[i]);
+        return out;
+    }
+}
+
+FusedSample fuse(const ExternalSample& sample, const Extrinsics& mount, const Pose& head) {
+    // Tracker frame -> world in one affine map: rotation head * mount, origin head applied to the mount offset
+    const Matrix3 rotation = multiply(head.matrix, Pose::quaternionToMatrix(mount.rotation));
+    const Vector3 origin = transform(head.matrix, head.position, mount.translation);
+
+    FusedSample out;
+    out.deviceTimeUs = head.timestamp;
+    out.hostTimeNs = sample.hostTimeNs;
+    out.source = sample.source;
+    out.kind = sample.kind;
+    out.id = sample.id;
+    out.pointCount = std::min(sample.pointCount, FUSION_MAX_POINTS);
+    out.headPosition = toFloat(head.position);
+    out.headOrientation = toFloat(head.quaternion);
+    const Vector4 local{sample.orientation[0], sample.orientation[1], sample.orientation[2], sample.orientation[3]};
+    out.orientation = toFloat(quat::normalize(quat::multiply(quat::multiply(head.quaternion, mount.rotation), local)));
+    for (uint32_t i = 0; i < out.pointCount; ++i) {
+        const Point3f& p = sample.points[i];
+        out.points[i] = toFloat(transform(rotation, origin, {p[0], p[1], p[2]}));
+    }
+    return out;
+}
+
+PoseFusion::PoseFusion(HeadSampler head) : head(std::move(head)) {}
+
+uint16_t PoseFusion::addSource(const Extrinsics& mount) {
+    if (sourceCount == MAX_SOURCES) throw std::runtime_error("Too many fusion sources");
+    // Unit length once here, so fuse() can build its matrix without a scale
+    sources[sourceCount].mount = {mount.translation, quat::normalize(mount.rotation)};
+    return uint16_t(sourceCount++);
+}
+
+std::shared_ptr<FusedRing> PoseFusion::openFusedRing() {
+    return rings.emplace_back(std::make_shared<FusedRing>());
+}
+
+Subscription PoseFusion::registerFusedCallback(const FusedCallback& callback, int priority) {
+    return subscribers->add(Subscriber<FusedSample>::callable(callback, priority));
+}
+
+bool PoseFusion::push(const ExternalSample& sample) {
+    if (sample.source >= sourceCount) {
+        unalignedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Source& source = sources[sample.source];
+
+    // Capture time on host steady_clock: the tracker clock's fit, or the receive time without one
+    int64_t capturedNs = sample.hostTimeNs;
+    if (sample.sourceTimeUs != 0) {
+        source.clock.observe(sample.sourceTimeUs, sample.hostTimeNs);
+        capturedNs = source.clock.deviceToHost(sample.sourceTimeUs);
+    }
+    const auto pose = head(capturedNs);
+    if (!pose) {
+        unalignedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    FusedSample out = fuse(sample, source.mount, *pose);
+    out.hostTimeNs = capturedNs;
+    for (const auto& ring : rings) ring->tryPush(out);
+    // The pushing thread is the table's reader: a callback may unsubscribe itself
+    subscribers->bindReader();
+    for (const auto& subscriber : subscribers->enter().fused) subscriber(out);
+    subscribers->leave();
+    fusedCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+int64_t PoseFusion::sourceLatency(uint16_t source) const {
+    return source < sourceCount ? sources[source].clock.lastLatency() : 0;
+}
+
+} // namespace xv
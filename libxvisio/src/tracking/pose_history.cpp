@@ -0,0 +1,36 @@
+/**
+ * @file pose_history.cpp
+ * @brief Bracketing search and interpolation over the pose history
+ */
+
+#include "pose_history.h"
+#include "quaternion.h"
+
+namespace xv {
+
+std::optional<Pose> PoseHistory::at(int64_t deviceTimeUs) const {
+    const uint64_t n = poses.count();
+    RawPose later;
+    if (n == 0 || !poses.read(n - 1, later)) return std::nullopt;
+    if (deviceTimeUs >= later.timeUs) return later.toPose();
+
+    // Walk back from the newest; the oldest slot may be under rewrite, so stop short of it
+    const uint64_t oldest = n > poses.capacity() - 1 ? n - (poses.capacity() - 1) : 0;
+    for (uint64_t index = n - 1; index-- > oldest;) {
+        RawPose earlier;
+        if (!poses.read(index, earlier)) return std::nullopt;  // lapped while searching
+        if (earlier.timeUs <= deviceTimeUs) {
+            const double span = double(later.timeUs - earlier.timeUs);
+            const double t = span > 0.0 ? (deviceTimeUs - earlier.timeUs) / span : 0.0;
+            const Vector3 a = earlier.position(), b = later.position();
+            const Vector3 position{a[0] + t * (b[0] - a[0]), a[1] + t * (b[1] - a[1]), a[2] + t * (b[2] - a[2])};
+            const Vector4 orientation =
+                quat::normalize(quat::slerp(earlier.orientation(), later.orientation(), t));
+            return Pose{position, orientation, deviceTimeUs};
+        }
+        later = earlier;
+    }
+    return std::nullopt;
+}
+
+} // namespace xv
@@ -0,0 +1,212 @@
+/**
+ * @file pose_hub.cpp
+ * @brief Packet decode, ring fan-out and callback dispatch
+ */
+
+#include "pose_hub.h"
+#include "logging.h"
+#include <algorithm>
+
+namespace xv {
+
+PoseHub::~PoseHub() {
+    stopDispatch();
+}
+
+void PoseHub::registerSlamCallback(const slamCallback& callback) {
+    subscribe<Pose>(callback).release();
+}
+
+void PoseHub::registerRawSlamCallback(const rawSlamCallback& callback) {
+    subscribe<RawPose>(callback).release();
+}
+
+void PoseHub::registerImuCallback(const imuCallback& callback) {
+    subscribe<ImuSample>(callback).release();
+}
+
+void PoseHub::registerPacketTap(const packetTap& tap) {
+    taps.push_back(tap);
+}
+
+std::shared_ptr<PoseRing> PoseHub::openPoseRing() {
+    return rings.emplace_back(std::make_shared<PoseRing>());
+}
+
+std::shared_ptr<ImuRing> PoseHub::openImuRing() {
+    return imuRings.emplace_back(std::make_shared<ImuRing>());
+}
+
+uint64_t PoseHub::droppedPoses() const {
+    return callbackRing ? callbackRing->drops() : 0;
+}
+
+void PoseHub::resetSession() {
+    frames = 0;
+    firstPacketNs = 0;
+    lastQuaternion = {};
+    validator.restart();
+    streamMetrics.reset();
+}
+
+void PoseHub::fillMetrics(SlamMetrics& out) const {
+    streamMetrics.fill(out);
+    out.droppedCallbackPoses = droppedPoses();
+    out.droppedRingPoses = 0;
+    for (const auto& ring : rings) out.droppedRingPoses += ring->drops();
+    out.droppedImuSamples = 0;
+    for (const auto& ring : imuRings) out.droppedImuSamples += ring->drops();
+}
+
+void PoseHub::expectDeviceRestart() {
+    restartPending = true;
+    firstPacketNs = 0;
+}
+
+bool PoseHub::waitFirstPacket(std::chrono::milliseconds timeout) {
+    std::unique_lock lock(firstPacketMutex);
+    return firstPacket.wait_for(lock, timeout, [this] { return firstPacketNs.load() != 0; });
+}
+
+std::optional<Pose> PoseHub::sampleAt(int64_t hostTimeNs) const {
+    if (!clockSync.synced()) return std::nullopt;
+    return history.at(clockSync.hostToDevice(hostTimeNs));
+}
+
+bool PoseHub::backlogged() const {
+    return callbackRing && callbackRing->size() >= PoseRing::capacity() - 1;
+}
+
+void PoseHub::startDispatch() {
+    // Not in rings: the producer only feeds it while someone is subscribed
+    if (!callbackRing) callbackRing = std::make_shared<PoseRing>();
+    if (!dispatchThread.joinable()) {
+        dispatching = true;
+        dispatchThread = std::thread(&PoseHub::dispatchHandler, this);
+    }
+}
+
+void PoseHub::stopDispatch() {
+    dispatching = false;
+    if (dispatchThread.joinable()) {
+        dispatchThread.join();
+    }
+}
+
+void PoseHub::dispatchHandler() {
+    using Clock = std::chrono::steady_clock;
+    subscribers->bindReader();
+    // Subscriber slots in metrics order: raw, pose, then IMU subscribers
+    auto timed = [this](size_t slot, const auto& subscriber, const auto& value) {
+        const auto started = Clock::now();
+        subscriber(value);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+        streamMetrics.subscriberCall(slot, elapsed.count());
+    };
+
+    RawPose raw;
+    const SubscriberSnapshot* described = nullptr;
+    // Keep draining after the stream ends so no decoded pose is silently lost
+    while (dispatching || !callbackRing->empty()) {
+        if (!callbackRing->waitFor(raw, std::chrono::milliseconds(50))) continue;
+        const SubscriberSnapshot& current = subscribers->enter();
+        if (&current != described) {
+            described = &current;
+            streamMetrics.describeSubscribers(current.raw.size(), current.pose.size(), current.imu.size());
+        }
+        size_t slot = 0;
+        for (const auto& subscriber : current.raw) {
+            timed(slot++, subscriber, raw);
+        }
+        // Double-precision pose (and its matrix) only when someone asked for it
+        if (!current.pose.empty()) {
+            const Pose pose = raw.toPose();
+            for (const auto& subscriber : current.pose) {
+                timed(slot++, subscriber, pose);
+            }
+        }
+        if (!current.imu.empty()) {
+            const ImuSample sample = imuCalibration.apply(raw);
+            for (const auto& subscriber : current.imu) {
+                timed(slot++, subscriber, sample);
+            }
+        }
+        subscribers->leave();
+    }
+}
+
+void PoseHub::publish(const uint8_t* packet, int length, int64_t hostTimeNs) {
+    for (const auto& tap : taps) {
+        tap(packet, length, hostTimeNs);
+    }
+
+    // Taps (recordings) keep everything; nothing else sees a short or foreign buffer
+    if (!validator.admit(packet, length)) return;
+
+    RawPose raw = RawPose::decode(packet);
+    const bool restarted = restartPending.load(std::memory_order_relaxed) && restartPending.exchange(false);
+    if (restarted) validator.restart();
+    if (!validator.admit(raw)) return;
+
+    // First packet means first pose delivered: a rejected one must not end the start retries
+    if (firstPacketNs.load(std::memory_order_relaxed) == 0) {
+        {
+            std::lock_guard lock(firstPacketMutex);
+            firstPacketNs = hostTimeNs;
+        }
+        firstPacket.notify_all();
+    }
+
+    if (conditionQuaternions.load(std::memory_order_relaxed)) {
+        lastQuaternion = raw.conditionQuaternion(lastQuaternion);
+    }
+
+    // Packets arrive here in order, so the counter unwraps monotonically
+    raw.timeUs = restarted ? clockSync.rebase(raw.timestamp, hostTimeNs) : clockSync.unwrap(raw.timestamp);
+    raw.hostTimeNs = hostTimeNs;
+    clockSync.observe(raw.timeUs, raw.hostTimeNs);
+    streamMetrics.packet(raw.timeUs, raw.hostTimeNs, clockSync.lastLatency());
+
+    // Diagnostics only exist in trace builds; the queue formats them off this thread
+    if constexpr (log::enabled(log::Level::Trace)) {
+        const int frame = frames.load();
+
+        // Dump raw hex: first 3 frames of every session + every 200th
+        // Separators: header | timestamp | translation(12B) | quat(8B) | rest
+        if (frame < 3 || frame % 200 == 0) {
+            XV_TRACE("Frame {} raw ({}B): {} | {} | {} | {} | {}", frame, length,
+                     log::Hex{packet, 3}, log::Hex{packet + 3, 4}, log::Hex{packet + 7, 12},
+                     log::Hex{packet + 19, 8}, log::Hex{packet + 27, size_t(std::max(length - 27, 0))});
+        }
+
+        // Log quaternion and extra bytes for first few frames
+        if (frame < 5) {
+            const Vector4 quaternion = raw.orientation();
+            XV_TRACE("Quat: w={} x={} y={} z={}", quaternion[0], quaternion[1], quaternion[2], quaternion[3]);
+            // Dump bytes 27-62 as int16 to look for more data
+            XV_TRACE("Extra int16 @27: {}", log::Int16s{packet + 27, 18});
+        }
+    }
+
+    frames.fetch_add(1);
+
+    // Packet taps above keep the raw packet; everyone below sees the smoothed pose
+    smoothing.apply(raw);
+    history.push(raw);
+
+    // Publishing is all the producer does; consumers pull on their own threads
+    for (const auto& ring : rings) {
+        ring->tryPush(raw);
+    }
+    if (callbackRing && subscribers->size()) {
+        callbackRing->tryPush(raw);
+    }
+    if (!imuRings.empty()) {
+        const ImuSample sample = imuCalibration.apply(raw);
+        for (const auto& ring : imuRings) {
+            ring->tryPush(sample);
+        }
+    }
+}
+
+} // namespace xv
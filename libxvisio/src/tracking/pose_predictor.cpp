@@ -0,0 +1,117 @@
+/**
+ * @file pose_predictor.cpp
+ * @brief Least-squares position and angular-velocity orientation extrapolation
+ */
+
+#include "pose_predictor.h"
+#include "quaternion.h"
+#include "slam.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace xv {
+
+namespace {
+    constexpr size_t MAX_WINDOW = 63;
+
+    /// Least-squares polynomial of the given degree (1 or 2) through (t, y), evaluated at `at`
+    double fitAndEvaluate(const double* t, const double* y, size_t n, int degree, double at) {
+        const int size = degree + 1;
+        // Normal equations: A[r][c] = sum t^(r+c), rhs[r] = sum y t^r
+        double a[3][4] = {};
+        for (size_t i = 0; i < n; ++i) {
+            double powers[5] = {1.0, t[i], t[i] * t[i], t[i] * t[i] * t[i], t[i] * t[i] * t[i] * t[i]};
+            for (int r = 0; r < size; ++r) {
+                for (int c = 0; c < size; ++c) a[r][c] += powers[r + c];
+                a[r][size] += y[i] * powers[r];
+            }
+        }
+        // Gaussian elimination; the system is tiny and well conditioned with t relative to the newest sample
+        for (int col = 0; col < size; ++col) {
+            int pivot = col;
+            for (int r = col + 1; r < size; ++r) {
+                if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+            }
+            if (std::abs(a[pivot][col]) < 1e-18) return y[n - 1];
+            std::swap(a[col], a[pivot]);
+            for (int r = 0; r < size; ++r) {
+                if (r == col) continue;
+                const double f = a[r][col] / a[col][col];
+                for (int c = col; c <= size; ++c) a[r][c] -= f * a[col][c];
+            }
+        }
+        double result = 0.0, power = 1.0;
+        for (int r = 0; r < size; ++r) {
+            result += a[r][size] / a[r][r] * power;
+            power *= at;
+        }
+        return result;
+    }
+}
+
+PosePredictor::PosePredictor(Options opts) : options(opts) {
+    options.window = std::clamp<size_t>(options.window, 3, MAX_WINDOW);
+}
+
+PosePredictor::PosePredictor(Slam& slam, Options opts) : PosePredictor(opts) {
+    subscription = slam.subscribe<&PosePredictor::update>(*this);
+}
+
+void PosePredictor::update(const RawPose& raw) {
+    Sample sample{raw.timeUs, raw.position(), quat::normalize(raw.orientation()), {}};
+    if (options.gyroScale > 0.0) {
+        sample.angularVelocity = {raw.gyro[0] * options.gyroScale, raw.gyro[1] * options.gyroScale,
+                                  raw.gyro[2] * options.gyroScale};
+    }
+    history.push(sample);
+}
+
+int64_t PosePredictor::latestTimeUs() const {
+    Sample newest{};
+    return history.latest(newest) ? newest.timeUs : 0;
+}
+
+std::optional<Pose> PosePredictor::predictAhead(int64_t leadUs) const {
+    Sample newest{};
+    if (!history.latest(newest)) return std::nullopt;
+    return predict(newest.timeUs + leadUs);
+}
+
+std::optional<Pose> PosePredictor::predict(int64_t targetTimeUs) const {
+    std::array<Sample, MAX_WINDOW> samples;
+    const size_t n = history.readRecent(samples.data(), options.window);
+    if (n < 2) return std::nullopt;
+
+    const Sample& newest = samples[n - 1];
+    const Sample& oldest = samples[0];
+    const int64_t leadUs = std::clamp(targetTimeUs - newest.timeUs, -options.maxHorizonUs, options.maxHorizonUs);
+    const double lead = leadUs * 1e-6;
+
+    // Position: polynomial fit over the window, times in seconds relative to the newest sample
+    const int degree = (options.model == Model::ConstantAcceleration && n >= 3) ? 2 : 1;
+    std::array<double, MAX_WINDOW> t, y;
+    for (size_t i = 0; i < n; ++i) t[i] = (samples[i].timeUs - newest.timeUs) * 1e-6;
+    Vector3 position;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        for (size_t i = 0; i < n; ++i) y[i] = samples[i].position[axis];
+        position[axis] = fitAndEvaluate(t.data(), y.data(), n, degree, lead);
+    }
+
+    // Orientation: integrate body-frame angular velocity forward from the newest rotation
+    Vector3 omega{};
+    if (options.gyroScale > 0.0) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t axis = 0; axis < 3; ++axis) omega[axis] += samples[i].angularVelocity[axis] / n;
+        }
+    } else if (const double span = (newest.timeUs - oldest.timeUs) * 1e-6; span > 0.0) {
+        const Vector4 from = quat::alignHemisphere(oldest.orientation, newest.orientation);
+        omega = quat::toAngularVelocity(quat::multiply(quat::conjugate(from), newest.orientation), span);
+    }
+    const Vector4 orientation =
+        quat::normalize(quat::multiply(newest.orientation, quat::fromAngularVelocity(omega, lead)));
+
+    return Pose{position, orientation, newest.timeUs + leadUs};
+}
+
+} // namespace xv
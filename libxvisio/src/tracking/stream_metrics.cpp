@@ -0,0 +1,126 @@
+/**
+ * @file stream_metrics.cpp
+ * @brief Per-packet rate, jitter and latency accounting
+ */
+
+#include "stream_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace xv {
+
+namespace {
+    constexpr int64_t WINDOW_NS = 1000000000;
+    constexpr auto relaxed = std::memory_order_relaxed;
+}
+
+void StreamMetrics::reset() {
+    packets.store(0, relaxed);
+    for (auto& bucket : histogram) bucket.store(0, relaxed);
+    packetRateHz.store(0.0, relaxed);
+    jitterUs.store(0.0, relaxed);
+    latencyNs.store(0, relaxed);
+    latencyMeanNs.store(0, relaxed);
+    latencyMaxNs.store(0, relaxed);
+    lastHostNs = -1;
+    jitter = 0.0;
+    windowPackets = 0;
+    windowLatencySum = 0;
+    windowLatencyMax = 0;
+    for (auto& count : rejections) count.store(0, relaxed);
+    substitutions.store(0, relaxed);
+    for (auto& subscriber : subscribers) {
+        subscriber.calls.store(0, relaxed);
+        subscriber.totalNs.store(0, relaxed);
+        subscriber.maxNs.store(0, relaxed);
+    }
+    for (auto& errors : transferErrors) errors.store(0, relaxed);
+    recoveryAttempts.store(0, relaxed);
+    recoveries.store(0, relaxed);
+}
+
+void StreamMetrics::packet(int64_t deviceTimeUs, int64_t hostTimeNs, int64_t latency) {
+    bump(packets);
+    latencyNs.store(latency, relaxed);
+
+    const int64_t transitNs = hostTimeNs - deviceTimeUs * 1000;
+    if (lastHostNs >= 0) {
+        const int64_t intervalUs = (hostTimeNs - lastHostNs) / 1000;
+        const auto& bounds = SlamMetrics::INTERVAL_BOUNDS_US;
+        bump(histogram[std::upper_bound(bounds.begin(), bounds.end(), intervalUs) - bounds.begin()]);
+
+        // RFC 3550: J += (|D| - J) / 16
+        jitter += (std::abs(double(transitNs - lastTransitNs)) - jitter) / 16.0;
+        jitterUs.store(jitter / 1000.0, relaxed);
+    } else {
+        windowStartNs = hostTimeNs;
+    }
+    lastHostNs = hostTimeNs;
+    lastTransitNs = transitNs;
+
+    windowPackets++;
+    windowLatencySum += latency;
+    windowLatencyMax = std::max(windowLatencyMax, latency);
+    if (const int64_t span = hostTimeNs - windowStartNs; span >= WINDOW_NS) {
+        packetRateHz.store(double(windowPackets) * 1e9 / double(span), relaxed);
+        latencyMeanNs.store(windowLatencySum / int64_t(windowPackets), relaxed);
+        latencyMaxNs.store(windowLatencyMax, relaxed);
+        windowStartNs = hostTimeNs;
+        windowPackets = 0;
+        windowLatencySum = 0;
+        windowLatencyMax = 0;
+    }
+}
+
+void StreamMetrics::describeSubscribers(size_t raw, size_t pose, size_t imu) {
+    for (auto& subscriber : subscribers) {
+        subscriber.calls.store(0, relaxed);
+        subscriber.totalNs.store(0, relaxed);
+        subscriber.maxNs.store(0, relaxed);
+    }
+    rawSubscribers.store(raw, relaxed);
+    poseSubscribers.store(pose, relaxed);
+    imuSubscribers.store(imu, relaxed);
+}
+
+void StreamMetrics::subscriberCall(size_t slot, int64_t elapsedNs) {
+    if (slot >= MAX_SUBSCRIBERS) return;
+    auto& subscriber = subscribers[slot];
+    bump(subscriber.calls);
+    bump(subscriber.totalNs, uint64_t(elapsedNs));
+    if (uint64_t(elapsedNs) > subscriber.maxNs.load(relaxed)) subscriber.maxNs.store(uint64_t(elapsedNs), relaxed);
+}
+
+void StreamMetrics::transferError(int status) {
+    if (status >= 0 && size_t(status) < transferErrors.size()) bump(transferErrors[status]);
+}
+
+void StreamMetrics::fill(SlamMetrics& out) const {
+    out.packets = packets.load(relaxed);
+    out.packetRateHz = packetRateHz.load(relaxed);
+    for (size_t i = 0; i < histogram.size(); ++i) out.interArrival[i] = histogram[i].load(relaxed);
+    out.jitterUs = jitterUs.load(relaxed);
+    out.latencyNs = latencyNs.load(relaxed);
+    out.latencyMeanNs = latencyMeanNs.load(relaxed);
+    out.latencyMaxNs = latencyMaxNs.load(relaxed);
+    for (size_t i = 0; i < rejections.size(); ++i) out.rejectedPackets[i] = rejections[i].load(relaxed);
+    out.substitutedPoses = substitutions.load(relaxed);
+
+    out.subscribers.clear();
+    const size_t counts[3] = {rawSubscribers.load(relaxed), poseSubscribers.load(relaxed), imuSubscribers.load(relaxed)};
+    const char* kinds[3] = {"raw", "pose", "imu"};
+    size_t slot = 0;
+    for (int kind = 0; kind < 3; ++kind) {
+        for (size_t index = 0; index < counts[kind] && slot < MAX_SUBSCRIBERS; ++index, ++slot) {
+            const auto& subscriber = subscribers[slot];
+            out.subscribers.push_back({kinds[kind], index, subscriber.calls.load(relaxed),
+                                       subscriber.totalNs.load(relaxed), subscriber.maxNs.load(relaxed)});
+        }
+    }
+
+    for (size_t i = 0; i < transferErrors.size(); ++i) out.transferErrors[i] = transferErrors[i].load(relaxed);
+    out.recoveryAttempts = recoveryAttempts.load(relaxed);
+    out.recoveries = recoveries.load(relaxed);
+}
+
+} // namespace xv
@@ -0,0 +1,70 @@
+/**
+ * @file subscription.cpp
+ * @brief Subscriber snapshot publication and the reader grace period
+ */
+
+#include "subscription.h"
+#include <algorithm>
+
+namespace xv {
+
+Subscription::Subscription(Subscription&& other) noexcept
+    : table(std::move(other.table)), id(other.id) {
+    other.table.reset();
+}
+
+Subscription& Subscription::operator=(Subscription&& other) noexcept {
+    if (this != &other) {
+        reset();
+        table = std::move(other.table);
+        id = other.id;
+        other.table.reset();
+    }
+    return *this;
+}
+
+void Subscription::reset() {
+    if (const auto owner = table.lock()) owner->remove(id);
+    table.reset();
+}
+
+void SubscriberTable::remove(uint64_t id) {
+    uint64_t target;
+    {
+        std::lock_guard lock(writer);
+        auto next = std::make_shared<SubscriberSnapshot>(*current);
+        const auto erase = [id](auto& list) {
+            return std::erase_if(list, [id](const auto& subscriber) { return subscriber.id == id; });
+        };
+        if (erase(next->raw) + erase(next->pose) + erase(next->imu) + erase(next->fused) == 0) return;
+        count.fetch_sub(1, std::memory_order_relaxed);
+        publish(std::move(next));
+        target = version.load();
+    }
+    // Outside the lock: the reader may need it to pick up the new snapshot
+    if (readerThread.load() != std::this_thread::get_id()) waitForReader(target);
+}
+
+void SubscriberTable::publish(std::shared_ptr<const SubscriberSnapshot> next) {
+    current = std::move(next);
+    version.fetch_add(1);
+}
+
+void SubscriberTable::waitForReader(uint64_t target) const {
+    // reading is raised before the reader loads version (both sequentially consistent),
+    // so either it sees target or we see it reading and wait for it to leave
+    while (reading.load() && readerVersion.load() < target) std::this_thread::yield();
+}
+
+const SubscriberSnapshot& SubscriberTable::enter() {
+    reading.store(true);
+    if (const uint64_t latest = version.load(); !held || latest != heldVersion) {
+        std::lock_guard lock(writer);
+        held = current;
+        heldVersion = version.load();
+    }
+    readerVersion.store(heldVersion);
+    return *held;
+}
+
+} // namespace xv
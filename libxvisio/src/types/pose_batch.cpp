@@ -0,0 +1,265 @@
+/**
+ * @file pose_batch.cpp
+ * @brief Scalar, SSE2, AVX2 and NEON pose conversion kernels with runtime dispatch
+ */
+
+#include "pose_batch.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define XV_BATCH_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define XV_BATCH_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define XV_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace xv::batch {
+
+namespace {
+    constexpr float SCALE = 6.103515625e-05f;  // 2^-14, exact in float
+
+    int32_t load32(const uint8_t* p) {
+        int32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    int16_t load16(const uint8_t* p) {
+        int16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    /// Scalar conversion of records [begin, end): the reference and every kernel's tail
+    void convertRange(const Source& in, const PoseArrays& out, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint8_t* record = in.base + i * in.stride;
+            if (out.timestamp) out.timestamp[i] = uint32_t(load32(record + in.timestampOffset));
+            for (int axis = 0; axis < 3; ++axis) {
+                out.position[axis][i] = float(load32(record + in.translationOffset + 4 * axis)) * SCALE;
+            }
+            const float w = float(load16(record + in.quaternionOffset)) * SCALE;
+            const float x = float(load16(record + in.quaternionOffset + 2)) * SCALE;
+            const float y = float(load16(record + in.quaternionOffset + 4)) * SCALE;
+            const float z = float(load16(record + in.quaternionOffset + 6)) * SCALE;
+            out.quaternion[0][i] = w;
+            out.quaternion[1][i] = x;
+            out.quaternion[2][i] = y;
+            out.quaternion[3][i] = z;
+            if (!out.matrix[0]) continue;
+            // Same expansion as Pose::quaternionToMatrix
+            out.matrix[0][i] = 1.0f - 2.0f * (y * y + z * z);
+            out.matrix[1][i] = 2.0f * (x * y - w * z);
+            out.matrix[2][i] = 2.0f * (x * z + w * y);
+            out.matrix[3][i] = 2.0f * (x * y + w * z);
+            out.matrix[4][i] = 1.0f - 2.0f * (x * x + z * z);
+            out.matrix[5][i] = 2.0f * (y * z - w * x);
+            out.matrix[6][i] = 2.0f * (x * z - w * y);
+            out.matrix[7][i] = 2.0f * (y * z + w * x);
+            out.matrix[8][i] = 1.0f - 2.0f * (x * x + y * y);
+        }
+    }
+
+    /// Four lanes of the int32 at offset in records i..i+3 (SSE2 and NEON have no gather)
+    void lanes4(const uint8_t* record, size_t stride, uint32_t offset, int32_t (&lanes)[4]) {
+        for (int lane = 0; lane < 4; ++lane) lanes[lane] = load32(record + lane * stride + offset);
+    }
+
+#if XV_BATCH_SSE2
+    void convertSse2(const Source& in, const PoseArrays& out) {
+        const __m128 scale = _mm_set1_ps(SCALE);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const size_t whole = in.count & ~size_t(3);
+        int32_t lanes[4];
+
+        for (size_t i = 0; i < whole; i += 4) {
+            const uint8_t* record = in.base + i * in.stride;
+            if (out.timestamp) {
+                lanes4(record, in.stride, in.timestampOffset, lanes);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.timestamp + i),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes)));
+            }
+            for (uint32_t axis = 0; axis < 3; ++axis) {
+                lanes4(record, in.stride, in.translationOffset + 4 * axis, lanes);
+                const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+                _mm_storeu_ps(out.position[axis] + i, _mm_mul_ps(_mm_cvtepi32_ps(raw), scale));
+            }
+
+            // Each int32 holds two int16 fields: low half first
+            lanes4(record, in.stride, in.quaternionOffset, lanes);
+            const __m128i wx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+            lanes4(record, in.stride, in.quaternionOffset + 4, lanes);
+            const __m128i yz = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+            const __m128 w = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(wx, 16), 16)), scale);
+            const __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(wx, 16)), scale);
+            const __m128 y = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(yz, 16), 16)), scale);
+            const __m128 z = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(yz, 16)), scale);
+            _mm_storeu_ps(out.quaternion[0] + i, w);
+            _mm_storeu_ps(out.quaternion[1] + i, x);
+            _mm_storeu_ps(out.quaternion[2] + i, y);
+            _mm_storeu_ps(out.quaternion[3] + i, z);
+            if (!out.matrix[0]) continue;
+
+            const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz2 = _mm_mul_ps(y, z);
+            const __m128 wx2 = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+            _mm_storeu_ps(out.matrix[0] + i, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+            _mm_storeu_ps(out.matrix[1] + i, _mm_mul_ps(two, _mm_sub_ps(xy, wz)));
+            _mm_storeu_ps(out.matrix[2] + i, _mm_mul_ps(two, _mm_add_ps(xz, wy)));
+            _mm_storeu_ps(out.matrix[3] + i, _mm_mul_ps(two, _mm_add_ps(xy, wz)));
+            _mm_storeu_ps(out.matrix[4] + i, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+            _mm_storeu_ps(out.matrix[5] + i, _mm_mul_ps(two, _mm_sub_ps(yz2, wx2)));
+            _mm_storeu_ps(out.matrix[6] + i, _mm_mul_ps(two, _mm_sub_ps(xz, wy)));
+            _mm_storeu_ps(out.matrix[7] + i, _mm_mul_ps(two, _mm_add_ps(yz2, wx2)));
+            _mm_storeu_ps(out.matrix[8] + i, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+        }
+        convertRange(in, out, whole, in.count);
+    }
+#endif
+
+#if XV_BATCH_AVX2
+    // Compiled for AVX2+FMA only; called only after the CPU check in resolve()
+    __attribute__((target("avx2,fma"))) void convertAvx2(const Source& in, const PoseArrays& out) {
+        const __m256 scale = _mm256_set1_ps(SCALE);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 minusTwo = _mm256_set1_ps(-2.0f);
+        const int stride = int(in.stride);
+        const __m256i lane = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+        const __m256i timestampAt = _mm256_add_epi32(lane, _mm256_set1_epi32(int(in.timestampOffset)));
+        const __m256i translationAt = _mm256_add_epi32(lane, _mm256_set1_epi32(int(in.translationOffset)));
+        const __m256i quaternionAt = _mm256_add_epi32(lane, _mm256_set1_epi32(int(in.quaternionOffset)));
+        const __m256i four = _mm256_set1_epi32(4);
+        const size_t whole = in.count & ~size_t(7);
+
+        for (size_t i = 0; i < whole; i += 8) {
+            const auto* record = reinterpret_cast<const int*>(in.base + i * in.stride);
+            if (out.timestamp) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.timestamp + i),
+                                    _mm256_i32gather_epi32(record, timestampAt, 1));
+            }
+            __m256i at = translationAt;
+            for (int axis = 0; axis < 3; ++axis, at = _mm256_add_epi32(at, four)) {
+                const __m256i raw = _mm256_i32gather_epi32(record, at, 1);
+                _mm256_storeu_ps(out.position[axis] + i, _mm256_mul_ps(_mm256_cvtepi32_ps(raw), scale));
+            }
+
+            const __m256i wx = _mm256_i32gather_epi32(record, quaternionAt, 1);
+            const __m256i yz = _mm256_i32gather_epi32(record, _mm256_add_epi32(quaternionAt, four), 1);
+            const __m256 w = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(wx, 16), 16)), scale);
+            const __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(wx, 16)), scale);
+            const __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(yz, 16), 16)), scale);
+            const __m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(yz, 16)), scale);
+            _mm256_storeu_ps(out.quaternion[0] + i, w);
+            _mm256_storeu_ps(out.quaternion[1] + i, x);
+            _mm256_storeu_ps(out.quaternion[2] + i, y);
+            _mm256_storeu_ps(out.quaternion[3] + i, z);
+            if (!out.matrix[0]) continue;
+
+            const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz2 = _mm256_mul_ps(y, z);
+            _mm256_storeu_ps(out.matrix[0] + i, _mm256_fmadd_ps(minusTwo, _mm256_add_ps(yy, zz), one));
+            _mm256_storeu_ps(out.matrix[1] + i, _mm256_mul_ps(two, _mm256_fnmadd_ps(w, z, xy)));
+            _mm256_storeu_ps(out.matrix[2] + i, _mm256_mul_ps(two, _mm256_fmadd_ps(w, y, xz)));
+            _mm256_storeu_ps(out.matrix[3] + i, _mm256_mul_ps(two, _mm256_fmadd_ps(w, z, xy)));
+            _mm256_storeu_ps(out.matrix[4] + i, _mm256_fmadd_ps(minusTwo, _mm256_add_ps(xx, zz), one));
+            _mm256_storeu_ps(out.matrix[5] + i, _mm256_mul_ps(two, _mm256_fnmadd_ps(w, x, yz2)));
+            _mm256_storeu_ps(out.matrix[6] + i, _mm256_mul_ps(two, _mm256_fnmadd_ps(w, y, xz)));
+            _mm256_storeu_ps(out.matrix[7] + i, _mm256_mul_ps(two, _mm256_fmadd_ps(w, x, yz2)));
+            _mm256_storeu_ps(out.matrix[8] + i, _mm256_fmadd_ps(minusTwo, _mm256_add_ps(xx, yy), one));
+        }
+        convertRange(in, out, whole, in.count);
+    }
+#endif
+
+#if XV_BATCH_NEON
+    void convertNeon(const Source& in, const PoseArrays& out) {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t two = vdupq_n_f32(2.0f);
+        const size_t whole = in.count & ~size_t(3);
+        int32_t lanes[4];
+
+        for (size_t i = 0; i < whole; i += 4) {
+            const uint8_t* record = in.base + i * in.stride;
+            if (out.timestamp) {
+                lanes4(record, in.stride, in.timestampOffset, lanes);
+                vst1q_u32(out.timestamp + i, vreinterpretq_u32_s32(vld1q_s32(lanes)));
+            }
+            for (uint32_t axis = 0; axis < 3; ++axis) {
+                lanes4(record, in.stride, in.translationOffset + 4 * axis, lanes);
+                vst1q_f32(out.position[axis] + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(lanes)), SCALE));
+            }
+
+            lanes4(record, in.stride, in.quaternionOffset, lanes);
+            const int32x4_t wx = vld1q_s32(lanes);
+            lanes4(record, in.stride, in.quaternionOffset + 4, lanes);
+            const int32x4_t yz = vld1q_s32(lanes);
+            const float32x4_t w = vmulq_n_f32(vcvtq_f32_s32(vshrq_n_s32(vshlq_n_s32(wx, 16), 16)), SCALE);
+            const float32x4_t x = vmulq_n_f32(vcvtq_f32_s32(vshrq_n_s32(wx, 16)), SCALE);
+            const float32x4_t y = vmulq_n_f32(vcvtq_f32_s32(vshrq_n_s32(vshlq_n_s32(yz, 16), 16)), SCALE);
+            const float32x4_t z = vmulq_n_f32(vcvtq_f32_s32(vshrq_n_s32(yz, 16)), SCALE);
+            vst1q_f32(out.quaternion[0] + i, w);
+            vst1q_f32(out.quaternion[1] + i, x);
+            vst1q_f32(out.quaternion[2] + i, y);
+            vst1q_f32(out.quaternion[3] + i, z);
+            if (!out.matrix[0]) continue;
+
+            const float32x4_t xx = vmulq_f32(x, x), yy = vmulq_f32(y, y), zz = vmulq_f32(z, z);
+            const float32x4_t xy = vmulq_f32(x, y), xz = vmulq_f32(x, z), yz2 = vmulq_f32(y, z);
+            vst1q_f32(out.matrix[0] + i, vmlsq_f32(one, two, vaddq_f32(yy, zz)));
+            vst1q_f32(out.matrix[1] + i, vmulq_f32(two, vmlsq_f32(xy, w, z)));
+            vst1q_f32(out.matrix[2] + i, vmulq_f32(two, vmlaq_f32(xz, w, y)));
+            vst1q_f32(out.matrix[3] + i, vmulq_f32(two, vmlaq_f32(xy, w, z)));
+            vst1q_f32(out.matrix[4] + i, vmlsq_f32(one, two, vaddq_f32(xx, zz)));
+            vst1q_f32(out.matrix[5] + i, vmulq_f32(two, vmlsq_f32(yz2, w, x)));
+            vst1q_f32(out.matrix[6] + i, vmulq_f32(two, vmlsq_f32(xz, w, y)));
+            vst1q_f32(out.matrix[7] + i, vmulq_f32(two, vmlaq_f32(yz2, w, x)));
+            vst1q_f32(out.matrix[8] + i, vmlsq_f32(one, two, vaddq_f32(xx, yy)));
+        }
+        convertRange(in, out, whole, in.count);
+    }
+#endif
+
+    struct Kernel {
+        void (*run)(const Source&, const PoseArrays&);
+        const char* name;
+    };
+
+    Kernel resolve() {
+#if XV_BATCH_AVX2
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return {convertAvx2, "avx2"};
+#endif
+#if XV_BATCH_SSE2
+        return {convertSse2, "sse2"};
+#elif XV_BATCH_NEON
+        return {convertNeon, "neon"};
+#else
+        return {convertScalar, "scalar"};
+#endif
+    }
+
+    const Kernel& selected() {
+        static const Kernel chosen = resolve();
+        return chosen;
+    }
+}
+
+void convertScalar(const Source& source, const PoseArrays& out) {
+    convertRange(source, out, 0, source.count);
+}
+
+void convert(const Source& source, const PoseArrays& out) {
+    selected().run(source, out);
+}
+
+const char* kernel() {
+    return selected().name;
+}
+
+} // namespace xv::batch
@@ -0,0 +1,39 @@
+/**
+ * @file raw_pose.cpp
+ * @brief Derived fields of the wire-decoded pose
+ */
+
+#include "raw_pose.h"
+#include <algorithm>
+#include <cmath>
+
+namespace xv {
+
+Vector3 RawPose::position() const {
+    return {translation[0] * FIXED_POINT_SCALE, translation[1] * FIXED_POINT_SCALE,
+            translation[2] * FIXED_POINT_SCALE};
+}
+
+Vector4 RawPose::orientation() const {
+    // Wire order is [w, x, y, z]; identity arrives as w ≈ -1
+    return {quaternion[0] * FIXED_POINT_SCALE, quaternion[1] * FIXED_POINT_SCALE,
+            quaternion[2] * FIXED_POINT_SCALE, quaternion[3] * FIXED_POINT_SCALE};
+}
+
+Matrix3 RawPose::matrix() const {
+    return Pose::quaternionToMatrix(orientation());
+}
+
+Vector3 RawPose::eulerDegrees() const {
+    const auto [w, x, y, z] = orientation();
+    constexpr double toDegrees = 180.0 / M_PI;
+    return {std::atan2(2.0 * (w * x + y * z), 1.0 - 2.0 * (x * x + y * y)) * toDegrees,
+            std::asin(std::clamp(2.0 * (w * y - z * x), -1.0, 1.0)) * toDegrees,
+            std::atan2(2.0 * (w * z + x * y), 1.0 - 2.0 * (y * y + z * z)) * toDegrees};
+}
+
+Pose RawPose::toPose() const {
+    return Pose{position(), orientation(), timeUs};
+}
+
+} // namespace xv
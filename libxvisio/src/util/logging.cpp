@@ -0,0 +1,213 @@
+/**
+ * @file logging.cpp
+ * @brief Lock-free log queue and its sink thread
+ */
+
+#include "logging.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace xv::log {
+
+namespace {
+    constexpr size_t QUEUE_SIZE = 512;
+
+    // Plain globals so they stay usable during static destruction
+    std::atomic<Level> threshold{Level::Trace};
+    std::atomic<uint64_t> droppedCount{0};
+    std::atomic_bool loggerGone{false};
+
+    void writeStderr(Level, std::string_view message) {
+        std::cerr << "[XR50] " << message << std::endl;
+    }
+
+    /// Bounded multi-producer queue (Vyukov): each cell's sequence says whose turn it is
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    class Logger {
+    public:
+        Logger() {
+            for (size_t i = 0; i < QUEUE_SIZE; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+            worker = std::thread(&Logger::run, this);
+        }
+
+        ~Logger() {
+            stopping.store(true);
+            wake();
+            worker.join();
+            loggerGone.store(true);
+        }
+
+        void push(const Record& record) {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &cells[pos % QUEUE_SIZE];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                } else {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->record = record;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed)) wake();
+        }
+
+        void flush() {
+            const size_t target = enqueuePos.load();
+            std::unique_lock lock(mutex);
+            drained.wait(lock, [&] { return written.load() >= target; });
+        }
+
+        void setSink(Sink s) {
+            std::lock_guard lock(sinkMutex);
+            sink = std::move(s);
+        }
+
+    private:
+        bool pop(Record& out) {
+            Cell& cell = cells[dequeuePos % QUEUE_SIZE];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) return false;
+            out = cell.record;
+            cell.sequence.store(dequeuePos + QUEUE_SIZE, std::memory_order_release);
+            ++dequeuePos;
+            return true;
+        }
+
+        void wake() {
+            std::lock_guard lock(mutex);
+            wakeup.notify_one();
+        }
+
+        void run() {
+            Record record;
+            for (;;) {
+                while (pop(record)) {
+                    {
+                        std::lock_guard lock(sinkMutex);
+                        sink(record.level, format(record));
+                    }
+                    written.store(dequeuePos);
+                }
+                {
+                    std::lock_guard lock(mutex);  // a flush() past its predicate check is now waiting
+                }
+                drained.notify_all();
+                if (stopping.load()) return;
+
+                std::unique_lock lock(mutex);
+                sleeping.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wakeup.wait(lock, [&] {
+                    return stopping.load() ||
+                           cells[dequeuePos % QUEUE_SIZE].sequence.load(std::memory_order_acquire) == dequeuePos + 1;
+                });
+                sleeping.store(false);
+            }
+        }
+
+        Cell cells[QUEUE_SIZE];
+        std::atomic<size_t> enqueuePos{0};
+        size_t dequeuePos = 0;
+        std::atomic<size_t> written{0};
+
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::condition_variable drained;
+        std::atomic_bool sleeping{false};
+        std::atomic_bool stopping{false};
+
+        std::mutex sinkMutex;
+        Sink sink = writeStderr;
+
+        std::thread worker;
+    };
+
+    Logger& logger() {
+        static Logger instance;
+        return instance;
+    }
+
+    void appendArg(std::string& out, const Record& record, const Record::Arg& arg) {
+        char buf[32];
+        const uint8_t* bytes = record.storage.data() + arg.offset;
+        switch (arg.kind) {
+            case Record::Kind::Int:
+                out += std::to_string(arg.i);
+                break;
+            case Record::Kind::UInt:
+                out += std::to_string(arg.u);
+                break;
+            case Record::Kind::Double:
+                std::snprintf(buf, sizeof(buf), "%g", arg.d);
+                out += buf;
+                break;
+            case Record::Kind::Text:
+                out.append(reinterpret_cast<const char*>(bytes), arg.length);
+                break;
+            case Record::Kind::Hex:
+                for (size_t i = 0; i < arg.length; ++i) {
+                    std::snprintf(buf, sizeof(buf), i ? " %02x" : "%02x", bytes[i]);
+                    out += buf;
+                }
+                break;
+            case Record::Kind::Int16s:
+                for (size_t i = 0; i < arg.length; ++i) {
+                    int16_t value;
+                    std::memcpy(&value, bytes + 2 * i, sizeof(value));
+                    if (i) out += ' ';
+                    out += std::to_string(value);
+                }
+                break;
+        }
+    }
+}
+
+std::string format(const Record& record) {
+    std::string out;
+    size_t next = 0;
+    for (const char* p = record.format; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}') {
+            if (next < record.argCount) appendArg(out, record, record.args[next++]);
+            ++p;
+        } else {
+            out += *p;
+        }
+    }
+    return out;
+}
+
+void submit(const Record& record) {
+    // Late logs from other static destructors are written synchronously
+    if (loggerGone.load()) return writeStderr(record.level, format(record));
+    logger().push(record);
+}
+
+void setSink(Sink sink) { logger().setSink(std::move(sink)); }
+
+void setLevel(Level lvl) { threshold.store(lvl, std::memory_order_relaxed); }
+
+Level level() { return threshold.load(std::memory_order_relaxed); }
+
+void flush() {
+    if (!loggerGone.load()) logger().flush();
+}
+
+uint64_t dropped() { return droppedCount.load(std::memory_order_relaxed); }
+
+} // namespace xv::log
@@ -0,0 +1,132 @@
+/**
+ * @file thread_policy.cpp
+ * @brief SCHED_FIFO/affinity/mlockall on Linux, QoS and time constraints on macOS, MMCSS on Windows
+ */
+
+#include "thread_policy.h"
+#include "logging.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <mach/thread_policy.h>
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <avrt.h>
+#endif
+
+namespace xv {
+
+namespace {
+    [[maybe_unused]] std::string cpuList(const std::vector<int>& cpus) {
+        std::string out;
+        for (const int cpu : cpus) out += (out.empty() ? "" : ",") + std::to_string(cpu);
+        return out;
+    }
+}
+
+#if defined(__linux__)
+
+void applyThreadPolicy(const ThreadPolicy& policy) {
+    if (!policy.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu : policy.cpus) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) throw std::runtime_error("No CPU " + std::to_string(cpu));
+            CPU_SET(cpu, &set);
+        }
+        if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+            throw std::runtime_error("Cannot pin to CPUs " + cpuList(policy.cpus) + ": " + std::strerror(error) +
+                                     " (outside this process's cpuset?)");
+        }
+    }
+
+    if (policy.realtimePriority > 0) {
+        sched_param param{};
+        param.sched_priority = std::clamp(policy.realtimePriority, sched_get_priority_min(SCHED_FIFO),
+                                          sched_get_priority_max(SCHED_FIFO));
+        if (const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) {
+            throw std::runtime_error("Cannot switch to SCHED_FIFO priority " + std::to_string(param.sched_priority) +
+                                     ": " + std::strerror(error) +
+                                     (error == EPERM ? " (needs root, CAP_SYS_NICE or an rtprio limit, see ulimit -r)" : ""));
+        }
+    }
+
+    if (policy.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        const int error = errno;
+        throw std::runtime_error(std::string("Cannot lock process memory: ") + std::strerror(error) +
+                                 " (needs CAP_IPC_LOCK or a memlock limit covering the process, see ulimit -l)");
+    }
+}
+
+#elif defined(__APPLE__)
+
+void applyThreadPolicy(const ThreadPolicy& policy) {
+    if (!policy.cpus.empty()) XV_WARN("macOS has no CPU pinning; ignoring affinity");
+    if (policy.lockMemory) XV_WARN("macOS has no mlockall; process memory stays pageable");
+
+    if (policy.realtimePriority > 0) {
+        pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+
+        // Woken every packet (~1 ms), needs well under a millisecond of it
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        const auto ticks = [&](double ns) { return uint32_t(ns * timebase.denom / timebase.numer); };
+        thread_time_constraint_policy_data_t constraint{ticks(1e6), ticks(1e5), ticks(5e5), 1};
+        const kern_return_t result =
+            thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY,
+                              reinterpret_cast<thread_policy_t>(&constraint), THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+        if (result != KERN_SUCCESS) {
+            throw std::runtime_error(std::string("Cannot set the real-time time-constraint policy: ") +
+                                     mach_error_string(result));
+        }
+    }
+}
+
+#elif defined(_WIN32)
+
+void applyThreadPolicy(const ThreadPolicy& policy) {
+    if (!policy.cpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (const int cpu : policy.cpus) {
+            if (cpu < 0 || cpu >= int(sizeof(mask) * 8)) throw std::runtime_error("No CPU " + std::to_string(cpu));
+            mask |= DWORD_PTR(1) << cpu;
+        }
+        if (!SetThreadAffinityMask(GetCurrentThread(), mask)) {
+            throw std::runtime_error("Cannot pin to CPUs " + cpuList(policy.cpus) + ": error " +
+                                     std::to_string(GetLastError()));
+        }
+    }
+    if (policy.lockMemory) XV_WARN("Windows locks memory per region only; process memory stays pageable");
+
+    if (policy.realtimePriority > 0) {
+        DWORD taskIndex = 0;
+        const HANDLE task = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+        if (!task || !AvSetMmThreadPriority(task, AVRT_PRIORITY_CRITICAL)) {
+            throw std::runtime_error("Cannot join the MMCSS \"Pro Audio\" task: error " +
+                                     std::to_string(GetLastError()) + " (is the MMCSS service running?)");
+        }
+    }
+}
+
+#else
+
+void applyThreadPolicy(const ThreadPolicy& policy) {
+    if (policy.realtimePriority > 0 || !policy.cpus.empty() || policy.lockMemory) {
+        XV_WARN("Thread policies are not supported on this platform; ignoring");
+    }
+}
+
+#endif
+
+} // namespace xv
@@ -2,26 +2,41 @@
 // Created by Mihir Patil on 8/6/23.
 //
 
-#include <iostream>
 #include "xvisio.h"
+#include "logging.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
 
 namespace xv {
-    XVisio::XVisio() {
+    namespace {
+        constexpr uint32_t DEFAULT_HID_TIMEOUT_MS = 1000;
+        constexpr size_t MAX_PARALLEL_OPENS = 8;
+
+        std::chrono::microseconds since(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    XVisio::XVisio() : XVisio(DEFAULT_HID_TIMEOUT_MS) {
+    }
+
+    XVisio::XVisio(uint32_t timeout) {
         if (const int res = libusb_init(&usb_ctx); res != 0) {
             throw std::runtime_error("USBInitFailure");
         }
+        eventLoop = std::make_unique<EventLoop>(usb_ctx);
 
-        libusb_device **list = nullptr;
-        const ssize_t nDevices = libusb_get_device_list(usb_ctx, &list);
-        for (int i = 0; i < nDevices; ++i) {
-            libusb_device_descriptor desc = {};
-            libusb_get_device_descriptor(list[i], &desc);
-            if (desc.idVendor == 0x040e && desc.idProduct == 0xf408) {
-                auto devPtr = std::make_shared<Device>(list[i], usb_ctx);
-                this->devices.push_back(devPtr);
-            }
+        try {
+            enumerate(timeout);
+        } catch (...) {
+            // The destructor does not run for a half-built XVisio
+            devices.clear();
+            eventLoop.reset();
+            libusb_exit(usb_ctx);
+            throw;
         }
-        libusb_free_device_list(list, 1);
 
         // Register hotplug — callback only queues the device pointer,
         // actual Device construction is deferred to pollNewDevices().
@@ -29,13 +44,82 @@ namespace xv {
             usb_ctx, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, LIBUSB_HOTPLUG_NO_FLAGS,
             0x040e, 0xf408, LIBUSB_HOTPLUG_MATCH_ANY,
             &XVisio::hotPlugCallback, this, &hotplugHandle);
+        // Reattaching does synchronous USB I/O and waits for packets: not on the event thread
+        arrivalThread = std::thread(&XVisio::handleArrivals, this);
     }
 
-    XVisio::XVisio(uint32_t timeout) {
+    void XVisio::enumerate(uint32_t timeout) {
+        const auto start = std::chrono::steady_clock::now();
+
+        libusb_device **list = nullptr;
+        const ssize_t nDevices = libusb_get_device_list(usb_ctx, &list);
+        std::vector<libusb_device*> matching;
+        for (int i = 0; i < nDevices; ++i) {
+            libusb_device_descriptor desc = {};
+            libusb_get_device_descriptor(list[i], &desc);
+            if (desc.idVendor == 0x040e && desc.idProduct == 0xf408) {
+                matching.push_back(list[i]);
+            }
+        }
+        enumerationTiming.listing = since(start);
+
+        // Each open is mostly waiting on its own device; HID round trips of different
+        // devices overlap on the event loop
+        std::vector<std::shared_ptr<Device>> opened(matching.size());
+        std::vector<std::exception_ptr> errors(matching.size());
+        enumerationTiming.devices.assign(matching.size(), {});
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t i = next++; i < matching.size(); i = next++) {
+                auto& entry = enumerationTiming.devices[i];
+                try {
+                    opened[i] = std::make_shared<Device>(matching[i], eventLoop.get(), timeout);
+                    entry.uuid = opened[i]->getUUID();
+                    entry.open = opened[i]->getOpenTiming().open;
+                    entry.identify = opened[i]->getOpenTiming().identify;
+                } catch (const std::exception& e) {
+                    errors[i] = std::current_exception();
+                    entry.error = e.what();
+                }
+                entry.total = since(start);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < std::min(matching.size(), MAX_PARALLEL_OPENS); ++i) workers.emplace_back(worker);
+        worker();
+        for (auto& thread : workers) thread.join();
+        libusb_free_device_list(list, 1);
+        enumerationTiming.total = since(start);
 
+        for (size_t i = 0; i < opened.size(); ++i) {
+            if (opened[i]) {
+                devices.push_back(opened[i]);
+            } else {
+                XV_ERROR("Cannot open device {}: {}", i, enumerationTiming.devices[i].error);
+            }
+        }
+        // Nothing usable: surface the reason (e.g. access denied) like a single open would
+        const auto firstError = std::find_if(errors.begin(), errors.end(), [](const auto& e) { return e != nullptr; });
+        if (devices.empty() && firstError != errors.end()) std::rethrow_exception(*firstError);
+
+        XV_DEBUG("Enumerated {} of {} device(s) in {} ms", devices.size(), matching.size(),
+                 enumerationTiming.total.count() / 1000.0);
     }
 
     XVisio::~XVisio() {
+        // No arrivals past this point: deregister, then let a callback already running on
+        // the event loop finish, so nothing is queued after the lists are drained below
+        if (usb_ctx && hotplugHandle) {
+            libusb_hotplug_deregister_callback(usb_ctx, hotplugHandle);
+            hotplugHandle = 0;
+        }
+        if (eventLoop) eventLoop->runSync([] {});
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            stopping = true;
+        }
+        pendingChanged.notify_all();
+        if (arrivalThread.joinable()) arrivalThread.join();
         devices.clear();
         // Release any pending devices that were never processed
         {
@@ -43,12 +127,14 @@ namespace xv {
             for (auto* dev : pendingDevices) {
                 libusb_unref_device(dev);
             }
+            for (auto* dev : newDevices) {
+                libusb_unref_device(dev);
+            }
             pendingDevices.clear();
+            newDevices.clear();
         }
         if (usb_ctx) {
-            if (hotplugHandle) {
-                libusb_hotplug_deregister_callback(usb_ctx, hotplugHandle);
-            }
+            eventLoop.reset();
             libusb_exit(usb_ctx);
             usb_ctx = nullptr;
         }
@@ -65,26 +151,59 @@ namespace xv {
             std::lock_guard<std::mutex> lock(self->pendingMutex);
             self->pendingDevices.push_back(device);
         }
-        std::cerr << "[XR50] Hotplug: device arrived (queued)" << std::endl;
+        self->pendingChanged.notify_all();
+        XV_INFO("Hotplug: device arrived (queued)");
         return 0;
     }
 
+    void XVisio::handleArrivals() {
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        while (true) {
+            pendingChanged.wait(lock, [this] { return stopping || !pendingDevices.empty(); });
+            if (stopping) return;
+            std::vector<libusb_device*> arrived;
+            arrived.swap(pendingDevices);
+            lock.unlock();
+
+            std::vector<std::shared_ptr<Device>> known;
+            {
+                std::lock_guard<std::mutex> devicesLock(devicesMutex);
+                known = devices;
+            }
+            std::vector<libusb_device*> unmatched;
+            for (auto* dev : arrived) {
+                const bool reattached = std::any_of(known.begin(), known.end(), [dev](const auto& device) {
+                    return !device->isConnected() && device->reattach(dev);
+                });
+                if (reattached) {
+                    libusb_unref_device(dev);
+                } else {
+                    unmatched.push_back(dev);
+                }
+            }
+
+            lock.lock();
+            newDevices.insert(newDevices.end(), unmatched.begin(), unmatched.end());
+        }
+    }
+
     void XVisio::pollNewDevices() {
         std::vector<libusb_device*> toProcess;
         {
             std::lock_guard<std::mutex> lock(pendingMutex);
-            toProcess.swap(pendingDevices);
+            toProcess.swap(newDevices);
         }
         for (auto* dev : toProcess) {
             try {
                 libusb_device_descriptor desc = {};
                 libusb_get_device_descriptor(dev, &desc);
                 if (desc.idVendor == 0x040e && desc.idProduct == 0xf408) {
-                    auto devPtr = std::make_shared<Device>(dev, usb_ctx);
+                    auto devPtr = std::make_shared<Device>(dev, eventLoop.get());
+                    std::lock_guard<std::mutex> lock(devicesMutex);
                     devices.push_back(devPtr);
                 }
             } catch (const std::exception& e) {
-                std::cerr << "[XR50] Hotplug device init: " << e.what() << std::endl;
+                XV_ERROR("Hotplug device init: {}", e.what());
             }
             libusb_unref_device(dev);
         }
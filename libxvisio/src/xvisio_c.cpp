@@ -0,0 +1,243 @@
+/**
+ * @file xvisio_c.cpp
+ * @brief C API over XVisio, Device and Slam: handles, error strings and pose conversion
+ */
+
+#include "xvisio_c.h"
+#include "xvisio.h"
+#include "raw_pose.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+static_assert(sizeof(XvPose) == 176 && sizeof(XvDeviceInfo) == 232, "C layouts are fixed");
+
+/// Keeps the USB context alive as long as any handle needs it
+struct XvDevice {
+    std::shared_ptr<xv::XVisio> context;
+    std::shared_ptr<xv::Device> device;
+    std::shared_ptr<xv::PoseRing> ring;  // opened by the first stream, reused by later ones
+};
+
+struct XvSlamStream {
+    std::shared_ptr<xv::XVisio> context;
+    std::shared_ptr<xv::Slam> slam;
+    std::shared_ptr<xv::PoseRing> ring;
+};
+
+namespace {
+    constexpr uint8_t SLAM_TRANSFERS = 4;  // as xvisio_test: absorbs host scheduling hiccups
+    constexpr auto POLL_STOPPED = std::chrono::milliseconds(100);  // how often a blocking recv checks for the end
+
+    thread_local std::string lastError;
+    thread_local bool hasError = false;
+
+    void setError(const char* message) {
+        lastError = message;
+        hasError = true;
+    }
+
+    /// One XVisio for every handle: a second one could not claim devices the first holds
+    std::mutex contextMutex;
+    std::weak_ptr<xv::XVisio> sharedContext;
+
+    std::shared_ptr<xv::XVisio> context() {
+        std::lock_guard lock(contextMutex);
+        if (auto existing = sharedContext.lock()) {
+            existing->pollNewDevices();
+            return existing;
+        }
+        auto created = std::make_shared<xv::XVisio>();
+        sharedContext = created;
+        return created;
+    }
+
+    template<size_t N>
+    void copyString(char (&out)[N], const std::string& value) {
+        const size_t length = std::min(value.size(), N - 1);
+        std::memcpy(out, value.data(), length);
+        out[length] = '\0';
+    }
+
+    /// Same conventions as xvisio-rs: quaternion x, y, z, w and Three.js Euler angles
+    void convert(const xv::RawPose& raw, XvPose& out) {
+        const auto position = raw.position();
+        const auto [w, x, y, z] = raw.orientation();
+        const auto matrix = xv::Pose::quaternionToMatrix({w, x, y, z});
+        for (size_t i = 0; i < 3; ++i) out.translation[i] = position[i];
+        for (size_t row = 0; row < 3; ++row) {
+            for (size_t column = 0; column < 3; ++column) out.rotation[3 * row + column] = matrix[row][column];
+        }
+        out.quaternion[0] = x;
+        out.quaternion[1] = y;
+        out.quaternion[2] = z;
+        out.quaternion[3] = w;
+        out.timestamp_us = uint64_t(raw.timeUs);
+        out.host_timestamp_s = double(raw.hostTimeNs) * 1e-9;
+        out.confidence = std::clamp(raw.confidence * xv::FIXED_POINT_SCALE, 0.0, 1.0);
+        // Z flipped into Three.js's frame, then YXZ angles for new THREE.Euler(pitch, yaw, roll, 'YXZ')
+        constexpr double toDegrees = 180.0 / M_PI;
+        out.euler_deg[0] = std::atan2(2.0 * (x * y + w * z), 1.0 - 2.0 * (x * x + z * z)) * toDegrees;
+        out.euler_deg[1] = std::asin(std::clamp(2.0 * (y * z - w * x), -1.0, 1.0)) * toDegrees;
+        out.euler_deg[2] = std::atan2(-2.0 * (x * z + w * y), 1.0 - 2.0 * (x * x + y * y)) * toDegrees;
+    }
+
+    /// Connected devices of the shared context, in enumeration order
+    std::vector<std::shared_ptr<xv::Device>> connected(const std::shared_ptr<xv::XVisio>& xvisio) {
+        std::vector<std::shared_ptr<xv::Device>> devices;
+        for (const auto& device : xvisio->getDevices()) {
+            if (device->isConnected()) devices.push_back(device);
+        }
+        return devices;
+    }
+}
+
+extern "C" {
+
+int xv_list_devices(XvDeviceInfo* out, int max) {
+    try {
+        const auto xvisio = context();  // outlives the Devices copied out of it
+        const auto devices = connected(xvisio);
+        const int count = std::min(int(devices.size()), std::max(max, 0));
+        for (int i = 0; out && i < count; ++i) {
+            auto& device = *devices[size_t(i)];
+            XvDeviceInfo& info = out[i];
+            copyString(info.uuid, device.getUUID());
+            copyString(info.version, device.getVersion());
+            info.features = device.getFeatures();
+            copyString(info.bus_id, device.getBusId());
+            info.address = device.getAddress();
+        }
+        return count;
+    } catch (const std::exception& e) {
+        setError(e.what());
+        return -1;
+    }
+}
+
+XvDevice* xv_open_first(void) {
+    try {
+        auto xvisio = context();
+        const auto devices = connected(xvisio);
+        if (devices.empty()) throw std::runtime_error("No XR50 found");
+        return new XvDevice{std::move(xvisio), devices.front(), nullptr};
+    } catch (const std::exception& e) {
+        setError(e.what());
+        return nullptr;
+    }
+}
+
+XvDevice* xv_open_device(const XvDeviceInfo* info) {
+    if (!info) {
+        setError("No device info given");
+        return nullptr;
+    }
+    try {
+        auto xvisio = context();
+        const std::string uuid(info->uuid, strnlen(info->uuid, sizeof(info->uuid)));
+        const std::string busId(info->bus_id, strnlen(info->bus_id, sizeof(info->bus_id)));
+        for (const auto& device : connected(xvisio)) {
+            if (uuid.empty() ? device->getBusId() == busId : device->getUUID() == uuid) {
+                return new XvDevice{std::move(xvisio), device, nullptr};
+            }
+        }
+        throw std::runtime_error("XR50 " + (uuid.empty() ? "at " + busId : uuid) + " not found");
+    } catch (const std::exception& e) {
+        setError(e.what());
+        return nullptr;
+    }
+}
+
+void xv_close_device(XvDevice* dev) {
+    delete dev;
+}
+
+const char* xv_device_uuid(const XvDevice* dev) {
+    return dev ? dev->device->getUUID().c_str() : nullptr;
+}
+
+const char* xv_device_version(const XvDevice* dev) {
+    return dev ? dev->device->getVersion().c_str() : nullptr;
+}
+
+uint32_t xv_device_features(const XvDevice* dev) {
+    return dev ? dev->device->getFeatures() : 0;
+}
+
+XvSlamStream* xv_start_slam(XvDevice* dev, int mode) {
+    if (!dev) {
+        setError("No device given");
+        return nullptr;
+    }
+    try {
+        auto slam = dev->device->getSlam();
+        if (slam->running()) throw std::runtime_error("SLAM is already streaming on this device");
+        if (!dev->ring) dev->ring = slam->openPoseRing();
+        xv::RawPose stale;
+        while (dev->ring->tryPop(stale)) {}  // left over from a previous stream
+        slam->setAutoReconnect(true);
+        slam->start(mode == 1 ? xv::Slam::mode::Mixed : xv::Slam::mode::Edge, SLAM_TRANSFERS);
+        return new XvSlamStream{dev->context, std::move(slam), dev->ring};
+    } catch (const std::exception& e) {
+        setError(e.what());
+        return nullptr;
+    }
+}
+
+int xv_slam_recv(XvSlamStream* stream, XvPose* pose, int timeout_ms) {
+    if (!stream || !pose) {
+        setError("No stream or pose given");
+        return -1;
+    }
+    xv::RawPose raw;
+    bool received = false;
+    if (timeout_ms == 0) {
+        received = stream->ring->tryPop(raw);
+    } else if (timeout_ms > 0) {
+        received = stream->ring->waitFor(raw, std::chrono::milliseconds(timeout_ms));
+    } else {
+        while (!(received = stream->ring->waitFor(raw, POLL_STOPPED)) && stream->slam->running()) {}
+    }
+    if (!received) {
+        setError(stream->slam->running() ? "Timed out waiting for a pose" : "SLAM stream stopped");
+        return -1;
+    }
+    convert(raw, *pose);
+    return 0;
+}
+
+int xv_slam_recv_many(XvSlamStream* stream, XvPose* out, int max) {
+    if (!stream || !out || max < 0) {
+        setError("No stream or output given");
+        return -1;
+    }
+    int count = 0;
+    xv::RawPose raw;
+    while (count < max && stream->ring->tryPop(raw)) convert(raw, out[count++]);
+    return count;
+}
+
+bool xv_slam_is_active(const XvSlamStream* stream) {
+    return stream && stream->slam->running();
+}
+
+void xv_stop_slam(XvSlamStream* stream) {
+    if (!stream) return;
+    try {
+        stream->slam->stop();
+    } catch (const std::exception& e) {
+        setError(e.what());
+    }
+    delete stream;
+}
+
+const char* xv_last_error(void) {
+    return hasError ? lastError.c_str() : nullptr;
+}
+
+} // extern "C"
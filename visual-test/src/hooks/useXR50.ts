@@ -4,6 +4,31 @@ import { createPoseFilter } from '../lib/one-euro-filter'
 
 const XR50_WS_URL = 'ws://localhost:8080'
 const RECONNECT_DELAY = 2000
+const RECORD_SIZE = 36 // libxvisio pose_record.h, sent by xvisio_server
+
+type RawPose = {
+  x: number; y: number; z: number
+  roll: number; pitch: number; yaw: number
+  t?: number
+}
+
+/** One binary pose record (µs time, position, quaternion WXYZ) as the JSON bridge's fields */
+const decodeRecord = (buffer: ArrayBuffer): RawPose | null => {
+  if (buffer.byteLength < RECORD_SIZE) return null // the "XVPS" preamble
+  const view = new DataView(buffer)
+  const f = (offset: number) => view.getFloat32(offset, true)
+  const [x, y, z] = [f(8), f(12), f(16)]
+  const [qw, qx, qy, qz] = [f(20), f(24), f(28), f(32)]
+  const toDegrees = 180 / Math.PI
+  // Same convention as RawPose::eulerDegrees()
+  return {
+    x, y, z,
+    roll: Math.atan2(2 * (qw * qx + qy * qz), 1 - 2 * (qx * qx + qy * qy)) * toDegrees,
+    pitch: Math.asin(Math.min(1, Math.max(-1, 2 * (qw * qy - qz * qx)))) * toDegrees,
+    yaw: Math.atan2(2 * (qw * qz + qx * qy), 1 - 2 * (qy * qy + qz * qz)) * toDegrees,
+    t: Number(view.getBigUint64(0, true)),
+  }
+}
 
 /**
  * Connects to the XR50 WebSocket bridge, applies 1€ filtering,
@@ -24,6 +49,7 @@ export const useXR50 = () => {
     const connect = () => {
       if (!alive) return
       const ws = new WebSocket(XR50_WS_URL)
+      ws.binaryType = 'arraybuffer'
       wsRef.current = ws
 
       ws.onopen = () => {
@@ -33,11 +59,8 @@ export const useXR50 = () => {
 
       ws.onmessage = (e) => {
         try {
-          const raw = JSON.parse(e.data) as {
-            x: number; y: number; z: number
-            roll: number; pitch: number; yaw: number
-            t?: number
-          }
+          const raw = e.data instanceof ArrayBuffer ? decodeRecord(e.data) : JSON.parse(e.data) as RawPose
+          if (!raw) return
 
           const now = performance.now() / 1000
           const filtered = filterRef.current(raw, raw.t ?? now)